@@ -0,0 +1,369 @@
+/* $Id$
+ * $Date$
+ * $Author$
+ * $Revision$
+ */
+
+/* synthlisa-bench: microbenchmarks for the simulation hot paths, each
+   exercised separately (interpolators, white noise, filters, armlengths,
+   CacheLISA retardations, TDI observables). For every benchmark, prints
+   a line
+
+     name <tab> calls <tab> ns/call <tab> calls/s
+
+   (lines beginning with # are comments). The same format is used for
+   baselines: with -b, each result is compared with the baseline, and the
+   exit status is 1 if any benchmark is slower by more than the tolerance.
+
+   usage: synthlisa-bench [-s scale] [-r repeats] [-o results.txt]
+                          [-b baseline.txt] [-t tolerance] [name-prefix ...]
+
+     -s  multiply the number of calls of every benchmark (default 1.0)
+     -r  run each benchmark this many times, and keep the fastest (default 3)
+     -o  also write the results to a file (e.g., to make a baseline)
+     -b  compare with a baseline file
+     -t  relative slowdown counted as a regression (default 0.10)
+
+   Benchmarks whose names do not begin with one of the given prefixes
+   are skipped. Filter benchmarks include the cost of the white noise
+   they filter. */
+
+#include "lisasim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+
+// results are summed into this, so that the compiler cannot drop the work
+
+static volatile double sink = 0.0;
+
+// each benchmark makes (about) "calls" calls, and returns their number
+
+typedef long (*benchfunction)(long calls);
+
+// --- interpolators ---
+
+static long benchinterp(Interpolator *interp,long calls) {
+    const long length = 1 << 16;
+
+    std::vector<double> data(length);
+    for(long i=0;i<length;i++) data[i] = sin(0.001 * i);
+
+    SampledSignalSource source(&data[0],length);
+
+    double sum = 0.0;
+
+    for(long i=0;i<calls;i++) {
+        long ind = 16 + (i % (length - 32));
+        sum += interp->getvalue(source,ind,0.37);
+    }
+
+    sink += sum;
+    delete interp;
+
+    return calls;
+}
+
+static long lagrange2(long calls) { return benchinterp(new LagrangeInterpolator(2),calls); }
+static long lagrange4(long calls) { return benchinterp(new LagrangeInterpolator(4),calls); }
+static long lagrange8(long calls) { return benchinterp(new LagrangeInterpolator(8),calls); }
+
+static long newlagrange2(long calls) { return benchinterp(new NewLagrangeInterpolator(2),calls); }
+static long newlagrange4(long calls) { return benchinterp(new NewLagrangeInterpolator(4),calls); }
+static long newlagrange8(long calls) { return benchinterp(new NewLagrangeInterpolator(8),calls); }
+
+// --- noise and filters ---
+
+static long whitenoise(long calls) {
+    WhiteNoiseSource noise(1024,1);
+
+    double sum = 0.0;
+    for(long i=0;i<calls;i++) sum += noise[i];
+
+    sink += sum;
+    return calls;
+}
+
+static long benchfilter(Filter *filter,long calls) {
+    WhiteNoiseSource noise(1024,1);
+    SignalFilter filtered(1024,&noise,filter);
+
+    double sum = 0.0;
+    for(long i=0;i<calls;i++) sum += filtered[i];
+
+    sink += sum;
+    delete filter;
+
+    return calls;
+}
+
+static long iirfilter(long calls) {
+    // second-order section, a[0]...a[2] on the input, b[0] = 0, b[1], b[2] on the output
+
+    double a[3] = {0.2, 0.4, 0.2}, b[3] = {0.0, 0.6, -0.2};
+
+    return benchfilter(new IIRFilter(a,3,b,3),calls);
+}
+
+static long firfilter(long calls) {
+    double a[16];
+    for(int k=0;k<16;k++) a[k] = 1.0/16.0;
+
+    return benchfilter(new FIRFilter(a,16),calls);
+}
+
+// --- armlengths and retardations ---
+
+static long armlengthbisection(long calls) {
+    EccentricInclined lisa;
+
+    double sum = 0.0;
+    for(long i=0;i<calls;i++) sum += lisa.LISA::armlength(1 + i % 3,10.0 * i);
+
+    sink += sum;
+    return calls;
+}
+
+static long armlengthexact(long calls) {
+    EccentricInclined lisa;
+
+    double sum = 0.0;
+    for(long i=0;i<calls;i++) sum += lisa.genarmlength(1 + i % 3,10.0 * i);
+
+    sink += sum;
+    return calls;
+}
+
+static long armlengthanalytic(long calls) {
+    EccentricInclined lisa;
+
+    double sum = 0.0;
+    for(long i=0;i<calls;i++) sum += lisa.armlength(1 + i % 3,10.0 * i);
+
+    sink += sum;
+    return calls;
+}
+
+// a fresh time for every triple retardation (cache misses), or the same
+// few times over and over (cache hits)
+
+static long benchretard(long calls,int hits) {
+    EccentricInclined basic;
+    CacheLISA lisa(&basic);
+
+    double sum = 0.0;
+
+    for(long i=0;i<calls;i++) {
+        lisa.newretardtime(hits ? 10.0 * (i % 4) : 10.0 * i);
+        lisa.retard(1); lisa.retard(-2); lisa.retard(3);
+
+        sum += lisa.retardedtime();
+    }
+
+    sink += sum;
+    return calls;
+}
+
+static long retardmiss(long calls) { return benchretard(calls,0); }
+static long retardhit(long calls) { return benchretard(calls,1); }
+
+// --- TDI observables ---
+
+static long benchobservable(TDI *tdi,const char *name,long calls) {
+    Signal *obs = tdi->observable(name);
+
+    double sum = 0.0;
+    for(long i=0;i<calls;i++) sum += obs->value(1.0 * i);
+
+    sink += sum;
+
+    delete obs;
+    return calls;
+}
+
+static long benchnoise(const char *name,long calls) {
+    WhiteNoiseSource::setglobalseed(1);
+
+    EccentricInclined basic;
+    CacheLISA lisa(&basic);
+    TDInoise tdi(&lisa);
+
+    return benchobservable(&tdi,name,calls);
+}
+
+static long benchsignal(const char *name,long calls) {
+    EccentricInclined basic;
+    CacheLISA lisa(&basic);
+    SimpleBinary wave(1.0e-3,0.0,0.5,1.0e-21,0.3,1.2,0.4);
+    TDIsignal tdi(&lisa,&wave);
+
+    return benchobservable(&tdi,name,calls);
+}
+
+static long noisex1(long calls) { return benchnoise("X1",calls); }
+static long noisealpha1(long calls) { return benchnoise("alpha1",calls); }
+static long signalx1(long calls) { return benchsignal("X1",calls); }
+static long signalalpha1(long calls) { return benchsignal("alpha1",calls); }
+
+// --- driver ---
+
+struct benchmark {
+    const char *name;
+    benchfunction function;
+    long calls;
+};
+
+static benchmark benchmarks[] = {
+    {"interp-lagrange-2",     lagrange2,          2000000},
+    {"interp-lagrange-4",     lagrange4,          1000000},
+    {"interp-lagrange-8",     lagrange8,           500000},
+    {"interp-newlagrange-2",  newlagrange2,       2000000},
+    {"interp-newlagrange-4",  newlagrange4,       1000000},
+    {"interp-newlagrange-8",  newlagrange8,        500000},
+    {"noise-white",           whitenoise,         4000000},
+    {"filter-iir",            iirfilter,          2000000},
+    {"filter-fir16",          firfilter,          1000000},
+    {"armlength-bisection",   armlengthbisection,   20000},
+    {"armlength-exact",       armlengthexact,       20000},
+    {"armlength-analytic",    armlengthanalytic,  1000000},
+    {"retard-miss",           retardmiss,          100000},
+    {"retard-hit",            retardhit,          1000000},
+    {"tdinoise-X1",           noisex1,              50000},
+    {"tdinoise-alpha1",       noisealpha1,         100000},
+    {"tdisignal-X1",          signalx1,             20000},
+    {"tdisignal-alpha1",      signalalpha1,         50000},
+    {0, 0, 0}
+};
+
+static std::map<std::string,double> readbaseline(const char *filename) {
+    std::map<std::string,double> baseline;
+
+    FILE *file = fopen(filename,"r");
+
+    if(!file) {
+        std::cerr << "synthlisa-bench: cannot open baseline " << filename << std::endl;
+        exit(2);
+    }
+
+    char line[1024], name[256];
+    long calls;
+    double nspercall;
+
+    while(fgets(line,sizeof(line),file))
+        if(line[0] != '#' && sscanf(line,"%255s %ld %lf",name,&calls,&nspercall) == 3)
+            baseline[name] = nspercall;
+
+    fclose(file);
+
+    return baseline;
+}
+
+static int selected(const char *name,const std::vector<const char *> &prefixes) {
+    if(prefixes.empty())
+        return 1;
+
+    for(unsigned int k=0;k<prefixes.size();k++)
+        if(!strncmp(name,prefixes[k],strlen(prefixes[k])))
+            return 1;
+
+    return 0;
+}
+
+int main(int argc,char **argv) {
+    double scale = 1.0, tolerance = 0.10;
+    int repeats = 3;
+
+    const char *outname = 0, *basename = 0;
+    std::vector<const char *> prefixes;
+
+    for(int arg=1;arg<argc;arg++) {
+        if(argv[arg][0] == '-' && arg + 1 < argc) {
+            char option = argv[arg][1];
+            const char *value = argv[++arg];
+
+            if(option == 's') scale = atof(value);
+            else if(option == 'r') repeats = atoi(value);
+            else if(option == 'o') outname = value;
+            else if(option == 'b') basename = value;
+            else if(option == 't') tolerance = atof(value);
+            else {
+                std::cerr << "synthlisa-bench: unknown option " << argv[arg-1] << std::endl;
+                return 2;
+            }
+        } else if(argv[arg][0] == '-') {
+            std::cerr << "usage: synthlisa-bench [-s scale] [-r repeats] [-o results.txt] "
+                      << "[-b baseline.txt] [-t tolerance] [name-prefix ...]" << std::endl;
+            return 2;
+        } else {
+            prefixes.push_back(argv[arg]);
+        }
+    }
+
+    std::map<std::string,double> baseline;
+    if(basename) baseline = readbaseline(basename);
+
+    FILE *out = outname ? fopen(outname,"w") : 0;
+
+    if(outname && !out) {
+        std::cerr << "synthlisa-bench: cannot write " << outname << std::endl;
+        return 2;
+    }
+
+    const char *header = "# name\tcalls\tns/call\tcalls/s\n";
+
+    printf("%s",header);
+    if(out) fprintf(out,"%s",header);
+
+    int regressions = 0;
+
+    for(benchmark *b = benchmarks; b->name; b++) {
+        if(!selected(b->name,prefixes))
+            continue;
+
+        long calls = (long)(scale * b->calls);
+        if(calls < 1) calls = 1;
+
+        double best = -1.0;
+        long made = 0;
+
+        for(int r=0;r<repeats;r++) {
+            long begin = profilenow();
+            made = b->function(calls);
+            long elapsed = profilenow() - begin;
+
+            double nspercall = (double)elapsed / made;
+            if(best < 0.0 || nspercall < best) best = nspercall;
+        }
+
+        char line[256];
+        sprintf(line,"%s\t%ld\t%.2f\t%.4g\n",b->name,made,best,1.0e9 / best);
+
+        printf("%s",line);
+        if(out) fprintf(out,"%s",line);
+
+        if(basename && baseline.count(b->name)) {
+            double ratio = best / baseline[b->name];
+
+            if(ratio > 1.0 + tolerance) {
+                printf("# REGRESSION %s: %.2f ns/call vs %.2f in baseline (x%.2f)\n",
+                       b->name,best,baseline[b->name],ratio);
+                regressions++;
+            }
+        }
+
+        fflush(stdout);
+    }
+
+    if(out) fclose(out);
+
+    if(basename)
+        printf("# %d regression(s) with respect to %s (tolerance %.0f%%)\n",regressions,basename,100.0*tolerance);
+
+    return regressions > 0 ? 1 : 0;
+}
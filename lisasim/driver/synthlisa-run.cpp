@@ -0,0 +1,453 @@
+/* $Id$
+ * $Date$
+ * $Author$
+ * $Revision$
+ */
+
+/* synthlisa-run: headless driver for production runs with a fixed
+   LISA + TDInoise + TDIsignal setup. Reads a key-value configuration
+   file (and "key=value" overrides from the command line), builds the
+   objects, and streams the observables to a binary file (native-endian
+   doubles or floats, one row per time, as in lisaXML Binary streams),
+   without Python.
+
+   usage: synthlisa-run [-v] config.txt [key=value ...]
+
+   Configuration keys (with defaults):
+
+     lisa = EccentricInclined    (or CircularRotating, OriginalLISA, ModifiedLISA)
+     lisa-eta0 = 0.0, lisa-xi0 = 0.0, lisa-sw = 1.0, lisa-t0 = 0.0
+                                 (initial orientation for the rotating LISAs)
+     lisa-arms = L,L,L           (armlengths in s for the stationary LISAs)
+
+     noise = standard            (or none)
+     noise-proof = 1.0,2.5e-48   (sampling time and PSD, as in TDInoise)
+     noise-shot = 1.0,1.8e-37
+     noise-laser = 1.0,1.1e-26
+     seed = 0                    (for WhiteNoiseSource::setglobalseed; 0 = from the clock,
+                                  drawn once and shared by all replicas)
+
+     source = SimpleBinary f phi0 inc amp beta lambda psi
+     source = SimpleMonochromatic f phi gamma amp beta lambda psi
+     source = GalacticBinary f fdot beta lambda amp inc psi phi0 [fddot [epsilon]]
+     source = GaussianPulse time decay gamma amp beta lambda psi
+     source = SineGaussian time decay f phi0 gamma amp beta lambda psi
+                                 (may be repeated; if there are no sources,
+                                  the observables are pure noise)
+
+     observables = X1,X2,X3     (any name known to TDI::observable)
+     samples = (required), timestep = 1.0, inittime = 0.0
+
+     output = (required)         (binary file)
+     format = double             (or float)
+     threads = 1                 (more threads build identical replicas, see fastgetobspar)
+
+   With -v, show progress on stderr. Ctrl-C stops the run after the
+   current batch, leaving the rows computed so far in the output file. */
+
+#include "lisasim.h"
+#include "lisasim-parallel.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+
+typedef std::map<std::string,std::string> config;
+
+// --- configuration parsing ---
+
+static std::string strip(const std::string &s) {
+    size_t beg = s.find_first_not_of(" \t\r\n");
+    size_t end = s.find_last_not_of(" \t\r\n");
+
+    return beg == std::string::npos ? std::string() : s.substr(beg,end - beg + 1);
+}
+
+// "source" lines accumulate in sources, everything else goes to conf
+
+static void parseline(const std::string &line,config &conf,std::vector<std::string> &sources,const char *where) {
+    std::string body = strip(line.substr(0,line.find('#')));
+
+    if(body.empty())
+        return;
+
+    size_t eq = body.find('=');
+
+    if(eq == std::string::npos) {
+        std::cerr << "synthlisa-run: cannot parse '" << body << "' (" << where << ")" << std::endl;
+        exit(1);
+    }
+
+    std::string key = strip(body.substr(0,eq)), value = strip(body.substr(eq+1));
+
+    if(key == "source")
+        sources.push_back(value);
+    else
+        conf[key] = value;
+}
+
+static void readconfig(const char *filename,config &conf,std::vector<std::string> &sources) {
+    FILE *file = fopen(filename,"r");
+
+    if(!file) {
+        std::cerr << "synthlisa-run: cannot open configuration file " << filename << std::endl;
+        exit(1);
+    }
+
+    char buffer[4096];
+
+    while(fgets(buffer,sizeof(buffer),file))
+        parseline(buffer,conf,sources,filename);
+
+    fclose(file);
+}
+
+static std::string getstring(config &conf,const char *key,const char *def = 0) {
+    if(conf.count(key))
+        return conf[key];
+
+    if(!def) {
+        std::cerr << "synthlisa-run: missing required key '" << key << "'" << std::endl;
+        exit(1);
+    }
+
+    return def;
+}
+
+// comma- or space-separated numbers
+
+static std::vector<double> getnumbers(const std::string &value,const char *key) {
+    std::vector<double> numbers;
+
+    const char *p = value.c_str();
+
+    while(*p) {
+        char *end;
+        double x = strtod(p,&end);
+
+        if(end == p) {
+            std::cerr << "synthlisa-run: bad number in '" << key << " = " << value << "'" << std::endl;
+            exit(1);
+        }
+
+        numbers.push_back(x);
+
+        p = end;
+        while(*p == ',' || *p == ' ' || *p == '\t') p++;
+    }
+
+    return numbers;
+}
+
+static double getdouble(config &conf,const char *key,const char *def = 0) {
+    std::vector<double> numbers = getnumbers(getstring(conf,key,def),key);
+
+    if(numbers.size() != 1) {
+        std::cerr << "synthlisa-run: '" << key << "' needs a single number" << std::endl;
+        exit(1);
+    }
+
+    return numbers[0];
+}
+
+static std::vector<double> getpair(config &conf,const char *key,const char *def) {
+    std::vector<double> numbers = getnumbers(getstring(conf,key,def),key);
+
+    if(numbers.size() != 2) {
+        std::cerr << "synthlisa-run: '" << key << "' needs two numbers (sampling time and PSD)" << std::endl;
+        exit(1);
+    }
+
+    return numbers;
+}
+
+static std::vector<std::string> getnames(config &conf,const char *key) {
+    std::vector<std::string> names;
+
+    std::string value = getstring(conf,key);
+
+    size_t beg = 0;
+
+    while(beg <= value.size()) {
+        size_t end = value.find(',',beg);
+        if(end == std::string::npos) end = value.size();
+
+        std::string name = strip(value.substr(beg,end - beg));
+        if(!name.empty()) names.push_back(name);
+
+        beg = end + 1;
+    }
+
+    return names;
+}
+
+// --- object construction ---
+
+static LISA *makelisa(config &conf) {
+    std::string type = getstring(conf,"lisa","EccentricInclined");
+
+    if(type == "EccentricInclined" || type == "CircularRotating") {
+        double eta0 = getdouble(conf,"lisa-eta0","0.0"), xi0 = getdouble(conf,"lisa-xi0","0.0");
+        double sw = getdouble(conf,"lisa-sw","1.0"), t0 = getdouble(conf,"lisa-t0","0.0");
+
+        if(type == "EccentricInclined")
+            return new EccentricInclined(eta0,xi0,sw,t0);
+        else
+            return new CircularRotating(eta0,xi0,sw,t0);
+    } else if(type == "OriginalLISA" || type == "ModifiedLISA") {
+        std::vector<double> arms(3,Lstd);
+
+        if(conf.count("lisa-arms")) {
+            arms = getnumbers(conf["lisa-arms"],"lisa-arms");
+
+            if(arms.size() != 3) {
+                std::cerr << "synthlisa-run: 'lisa-arms' needs three armlengths" << std::endl;
+                exit(1);
+            }
+        }
+
+        if(type == "OriginalLISA")
+            return new OriginalLISA(arms[0],arms[1],arms[2]);
+        else
+            return new ModifiedLISA(arms[0],arms[1],arms[2]);
+    }
+
+    std::cerr << "synthlisa-run: unknown LISA class " << type << std::endl;
+    exit(1);
+}
+
+static Wave *makewave(const std::string &source) {
+    std::string type = source.substr(0,source.find_first_of(" \t"));
+    std::vector<double> p = getnumbers(strip(source.substr(type.size())),"source");
+
+    if(type == "SimpleBinary" && p.size() == 7)
+        return new SimpleBinary(p[0],p[1],p[2],p[3],p[4],p[5],p[6]);
+    else if(type == "SimpleMonochromatic" && p.size() == 7)
+        return new SimpleMonochromatic(p[0],p[1],p[2],p[3],p[4],p[5],p[6]);
+    else if(type == "GalacticBinary" && p.size() >= 8 && p.size() <= 10)
+        return new GalacticBinary(p[0],p[1],p[2],p[3],p[4],p[5],p[6],p[7],
+                                  p.size() > 8 ? p[8] : 0.0,p.size() > 9 ? p[9] : 0.0);
+    else if(type == "GaussianPulse" && p.size() == 7)
+        return new GaussianPulse(p[0],p[1],p[2],p[3],p[4],p[5],p[6]);
+    else if(type == "SineGaussian" && p.size() == 9)
+        return new SineGaussian(p[0],p[1],p[2],p[3],p[4],p[5],p[6],p[7],p[8]);
+
+    std::cerr << "synthlisa-run: cannot build source '" << source << "'" << std::endl;
+    exit(1);
+}
+
+// one complete set of objects; threads > 1 use identical replicas
+
+struct simulation {
+    LISA *lisa;
+
+    TDI *noise, *signal;
+
+    std::vector<Signal *> observables;
+};
+
+static void makesimulation(simulation &sim,config &conf,const std::vector<std::string> &sources,
+                           const std::vector<std::string> &names,unsigned long seed) {
+    sim.lisa = new CacheLISA(makelisa(conf));
+
+    sim.noise = 0;
+
+    if(getstring(conf,"noise","standard") == "standard") {
+        std::vector<double> proof = getpair(conf,"noise-proof","1.0,2.5e-48");
+        std::vector<double> shot = getpair(conf,"noise-shot","1.0,1.8e-37");
+        std::vector<double> laser = getpair(conf,"noise-laser","1.0,1.1e-26");
+
+        // every replica starts from the same seed
+
+        WhiteNoiseSource::setglobalseed(seed);
+
+        sim.noise = new TDInoise(sim.lisa,proof[0],proof[1],shot[0],shot[1],laser[0],laser[1]);
+    } else if(getstring(conf,"noise") != "none") {
+        std::cerr << "synthlisa-run: noise must be 'standard' or 'none'" << std::endl;
+        exit(1);
+    }
+
+    sim.signal = 0;
+
+    if(!sources.empty()) {
+        Wave **waves = new Wave*[sources.size()];
+
+        for(unsigned int i=0;i<sources.size();i++)
+            waves[i] = makewave(sources[i]);
+
+        sim.signal = new TDIsignal(sim.lisa,new WaveArray(waves,sources.size()));
+    }
+
+    if(!sim.noise && !sim.signal) {
+        std::cerr << "synthlisa-run: no noise and no sources, nothing to compute" << std::endl;
+        exit(1);
+    }
+
+    for(unsigned int j=0;j<names.size();j++) {
+        TDI *probe = sim.noise ? sim.noise : sim.signal;
+        Signal *obs = probe->observable(names[j].c_str());
+
+        if(!obs) {
+            std::cerr << "synthlisa-run: unknown TDI observable " << names[j] << std::endl;
+            exit(1);
+        }
+
+        if(sim.noise && sim.signal)
+            obs = new SumSignal(obs,sim.signal->observable(names[j].c_str()));
+
+        sim.observables.push_back(obs);
+    }
+}
+
+// --- output ---
+
+static void writerows(FILE *file,double *buffer,long values,int single) {
+    size_t written;
+
+    if(single) {
+        std::vector<float> fbuffer(buffer,buffer + values);
+        written = fwrite(&fbuffer[0],sizeof(float),values,file);
+    } else {
+        written = fwrite(buffer,sizeof(double),values,file);
+    }
+
+    if(written != (size_t)values) {
+        std::cerr << "synthlisa-run: error writing output file" << std::endl;
+        exit(1);
+    }
+}
+
+// Ctrl-C cancels the run at the next batch (see cancelobs)
+
+static void handleinterrupt(int sig) {
+    cancelobs();
+}
+
+int main(int argc,char **argv) {
+    int display = 0;
+    int arg = 1;
+
+    if(arg < argc && !strcmp(argv[arg],"-v")) {
+        display = 1;
+        arg++;
+    }
+
+    if(arg >= argc) {
+        std::cerr << "usage: synthlisa-run [-v] config.txt [key=value ...]" << std::endl;
+        return 1;
+    }
+
+    config conf;
+    std::vector<std::string> sources;
+
+    readconfig(argv[arg++],conf,sources);
+
+    for(;arg<argc;arg++)
+        parseline(argv[arg],conf,sources,"command line");
+
+    std::vector<std::string> names = getnames(conf,"observables");
+
+    long samples = (long)getdouble(conf,"samples");
+    double stime = getdouble(conf,"timestep","1.0");
+    double inittime = getdouble(conf,"inittime","0.0");
+
+    std::string output = getstring(conf,"output");
+    std::string format = getstring(conf,"format","double");
+    int threads = (int)getdouble(conf,"threads","1");
+
+    if(names.empty() || samples <= 0 || threads < 1 || (format != "double" && format != "float")) {
+        std::cerr << "synthlisa-run: need observables, samples > 0, threads >= 1, "
+                  << "and format 'double' or 'float'" << std::endl;
+        return 1;
+    }
+
+    int single = (format == "float");
+    int obs = names.size();
+
+    // resolve a clock seed once, so that all replicas build the same noises
+
+    unsigned long seed = (unsigned long)getdouble(conf,"seed","0");
+
+    if(seed == 0) {
+        WhiteNoiseSource::setglobalseed(0);
+        seed = WhiteNoiseSource::getglobalseed();
+    }
+
+    if(display)
+        std::cerr << "synthlisa-run: noise seed " << seed << std::endl;
+
+    std::vector<simulation> sims(threads);
+
+    for(int r=0;r<threads;r++)
+        makesimulation(sims[r],conf,sources,names,seed);
+
+    signal(SIGINT,handleinterrupt);
+
+    try {
+        if(threads == 1) {
+            fastgetobsfile(output.c_str(),samples,stime,&sims[0].observables[0],obs,inittime,display,0,single);
+        } else {
+            FILE *file = fopen(output.c_str(),"wb");
+
+            if(!file) {
+                std::cerr << "synthlisa-run: cannot open output file " << output << std::endl;
+                return 1;
+            }
+
+            // observables ordered by replica, as fastgetobspar wants them
+
+            std::vector<Signal *> allobs;
+
+            for(int r=0;r<threads;r++)
+                allobs.insert(allobs.end(),sims[r].observables.begin(),sims[r].observables.end());
+
+            // each block is split across the replicas; every replica then
+            // skips forward to its chunk of the next block, regenerating
+            // the noises in between (which is cheap compared to TDI)
+
+            long block = 16384L * threads;
+            std::vector<double> buffer(block * obs);
+
+            for(long mini=0;mini<samples;mini+=block) {
+                long rows = samples - mini < block ? samples - mini : block;
+
+                // pass the row offset rather than inittime + mini*stime, so
+                // that sample times are bit-identical to threads = 1
+
+                fastgetobspar(&buffer[0],rows*obs,rows,stime,&allobs[0],threads*obs,threads,inittime,0,mini);
+                writerows(file,&buffer[0],rows*obs,single);
+
+                if(display)
+                    fprintf(stderr,"\r...%ld/%ld rows done",mini + rows,samples);
+            }
+
+            if(display)
+                fprintf(stderr,"\n");
+
+            if(fclose(file) != 0) {
+                std::cerr << "synthlisa-run: error closing output file " << output << std::endl;
+                return 1;
+            }
+        }
+    } catch (ExceptionCancelled &e) {
+        std::cerr << "synthlisa-run: interrupted, output is incomplete" << std::endl;
+        return 130;
+    } catch (ExceptionFileError &e) {
+        std::cerr << "synthlisa-run: I/O error" << std::endl;
+        return 1;
+    } catch (ExceptionOutOfBounds &e) {
+        std::cerr << "synthlisa-run: out-of-bounds access (buffers too short?)" << std::endl;
+        return 1;
+    } catch (ExceptionUndefined &e) {
+        std::cerr << "synthlisa-run: undefined error" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
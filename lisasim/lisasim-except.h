@@ -16,5 +16,6 @@ class ExceptionUndefined : SynthLISAException {};
 class ExceptionWrongArguments : SynthLISAException {};
 class ExceptionFileError : SynthLISAException {};
 class ExceptionKeyboardInterrupt : SynthLISAException {};
+class ExceptionCancelled : SynthLISAException {};
 
 #endif /* _LISASIM_EXCEPT_H_ */
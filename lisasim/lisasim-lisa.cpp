@@ -7,6 +7,7 @@
 #include "lisasim-lisa.h"
 #include "lisasim-signal.h"
 #include "lisasim-except.h"
+#include "lisasim-profile.h"
 
 #include <iostream>
 
@@ -97,11 +98,21 @@ double LISA::armlength(int arms, double t) {
         }
         
         newguess = 0.5 * (hi + lo);
+
+        armiterations++;
     } while( fabs(newguess - guess) > tol );
 
     return newguess;
 }
 
+void LISA::addcounters(EventCounters &counters) {
+    counters.add("armlength-iterations",armiterations);
+}
+
+void LISA::resetcounters() {
+    armiterations = 0;
+}
+
 double LISA::dotarmlength(int arm, double t) {
     return (armlength(arm,t + 0.5) - armlength(arm,t - 0.5));
 }
@@ -124,6 +135,8 @@ double LISA::retardation() {
 
 void LISA::retard(int ret) {
     if (ret != 0) {
+		PROFILESTAGE(profilearmlength);
+
 		trb += armlengthbaseline(ret,rt);  
 		tra += armlengthaccurate(ret,rt);
 
@@ -133,6 +146,8 @@ void LISA::retard(int ret) {
 
 void LISA::retard(LISA *anotherlisa, int ret) {
     if (ret != 0) {
+		PROFILESTAGE(profilearmlength);
+
 		trb += anotherlisa->armlengthbaseline(ret,rt);  
 		tra += anotherlisa->armlengthaccurate(ret,rt);
 
@@ -219,6 +234,14 @@ double OriginalLISA::armlength(int arms, double t) {
 	return L[abs(arms)];
 }
 
+int OriginalLISA::delaysymmetry() {
+    int symmetry = delaystatic | delaysymmetric;
+
+    if(L[1] == L[2] && L[2] == L[3]) symmetry |= delayequal;
+
+    return symmetry;
+}
+
 // --- ModifiedLISA LISA class ---------------------------------------------------------
 
 ModifiedLISA::ModifiedLISA(double arm1,double arm2,double arm3) : OriginalLISA(arm1,arm2,arm3) {
@@ -271,6 +294,16 @@ double ModifiedLISA::genarmlength(int arm, double t) {
     return LISA::armlength(arm,t);
 }
 
+// the Sagnac effect makes the armlengths depend on direction
+
+int ModifiedLISA::delaysymmetry() {
+    int symmetry = delaystatic;
+
+    if(Lc[1] == Lc[2] && Lc[2] == Lc[3] && Lac[1] == Lac[2] && Lac[2] == Lac[3]) symmetry |= delayequal;
+
+    return symmetry;
+}
+
 // ??? modernized up to here
 
 // --- CircularRotating LISA class -----------------------------------------------------
@@ -539,6 +572,8 @@ void EccentricInclined::initialize(double e0,double x0,double sw) {
     // Initialize the position cache
 
     settime(1,0.0); settime(2,0.0); settime(3,0.0);
+
+    settimes = 0;
 }
 
 // positions of spacecraft according to the LISA simulator
@@ -580,6 +615,20 @@ void EccentricInclined::settime(int craft, double t) {
                        + sqrt3 * Rgc * sqecc * ( cos(alpha-beta)*cos(alpha-beta) + 2.0*sin(alpha-beta)*sin(alpha-beta) );                                               
 
     cachetime[craft] = t;
+
+    settimes++;
+}
+
+void EccentricInclined::addcounters(EventCounters &counters) {
+    counters.add("settime-recomputations",settimes);
+
+    LISA::addcounters(counters);
+}
+
+void EccentricInclined::resetcounters() {
+    settimes = 0;
+
+    LISA::resetcounters();
 }
 
 void EccentricInclined::putp(Vector &p, int craft, double t) {
@@ -666,104 +715,36 @@ SampledLISA::~SampledLISA() {
     }
 }
 
-void SampledLISA::putp(Vector &p,int craft,double t) {
-	assertCraft(craft);
-
-	for(int i=0;i<3;i++) {
-		p[i] = sampledp[craft][i]->value(t);
-	}
+void SampledLISA::savestate(FILE *file) {
+    for(int craft=1;craft<4;craft++)
+        for(int i=0;i<3;i++) sampledp[craft][i]->savestate(file);
 }
 
-
-// --- PyLISA ---
-
-void PyLISA::reset() {
-	return baseLISA->reset();
+void SampledLISA::loadstate(FILE *file) {
+    for(int craft=1;craft<4;craft++)
+        for(int i=0;i<3;i++) sampledp[craft][i]->loadstate(file);
 }
 
-LISA* PyLISA::physlisa() {
-	return baseLISA;
-}
+void SampledLISA::addcounters(EventCounters &counters) {
+    for(int craft=1;craft<4;craft++)
+        for(int i=0;i<3;i++) sampledp[craft][i]->getcounters(counters);
 
-double PyLISA::armlength(int arm, double t) {
-	PyObject *arglist, *result;
-  
-	double dres = 0.0;
-	
-	arglist = Py_BuildValue("(id)",arm,t);        // Build argument list
-	result = PyEval_CallObject(armfunc,arglist);  // Call Python
-	Py_DECREF(arglist);                           // Trash arglist
-	if (result) dres = PyFloat_AsDouble(result);  // If no errors, return double
-	Py_XDECREF(result);                           // Trash result
-	return dres;
+    LISA::addcounters(counters);
 }
 
-double PyLISA::armlengthbaseline(int arm, double t) {
-	return armlength(arm,t);
-}
+void SampledLISA::resetcounters() {
+    for(int craft=1;craft<4;craft++)
+        for(int i=0;i<3;i++) sampledp[craft][i]->resetcounters();
 
-double PyLISA::armlengthaccurate(int arm, double t) {
-	return 0.0;
+    LISA::resetcounters();
 }
 
-void PyLISA::putn(Vector &n, int arm, double t) {
-	baseLISA->putn(n,arm,t);
-}
-    
-void PyLISA::putp(Vector &p, int craft, double t) {
-	baseLISA->putp(p,craft,t);
-}
-
-// --- AllPyLISA ---
-
-// problem here: setLguesses needs the virtual putp, which may not be ready
-
-AllPyLISA::AllPyLISA(PyObject *cfunc,PyObject *afunc) : craftfunc(cfunc), armlengthfunc(afunc) {
-	setguessL();
-}
-
-void AllPyLISA::reset() {
-	setguessL();
-}
-
-double AllPyLISA::armlength(int arm, double t) {
-	if (armlengthfunc != 0) {
-		PyObject *arglist, *result;
-    
-		double dres = 0.0;
-    
-		arglist = Py_BuildValue("(id)",arm,t);              // Build argument list
-		result = PyEval_CallObject(armlengthfunc,arglist);  // Call Python
-		Py_DECREF(arglist);                                 // Trash arglist
-		if (result) dres = PyFloat_AsDouble(result);        // If no errors, return double
-		// no type checking!
-		Py_XDECREF(result);                                 // Trash result
-		return dres;
-	} else {
-		return LISA::armlength(arm,t);
-	}
-}
-
-double AllPyLISA::armlengthbaseline(int arm, double t) {
-	return armlength(arm,t);
-}
+void SampledLISA::putp(Vector &p,int craft,double t) {
+	assertCraft(craft);
 
-double AllPyLISA::armlengthaccurate(int arm, double t) {
-	return 0.0;
-}
-    
-void AllPyLISA::putp(Vector &p, int craft, double t) {
-	PyObject *arglist, *result;
-        
-	arglist = Py_BuildValue("(id)",craft,t);        // Build argument list
-	result = PyEval_CallObject(craftfunc,arglist);  // Call Python
-	Py_DECREF(arglist);                             // Trash arglist
-	if (result) {                                   // If no errors, get results
-		p[0] = PyFloat_AsDouble(PyTuple_GetItem(result,0));
-		p[1] = PyFloat_AsDouble(PyTuple_GetItem(result,1));
-		p[2] = PyFloat_AsDouble(PyTuple_GetItem(result,2));
+	for(int i=0;i<3;i++) {
+		p[i] = sampledp[craft][i]->value(t);
 	}
-	Py_XDECREF(result);                             // Trash result
 }
 
 
@@ -829,6 +810,40 @@ void CacheLengthLISA::reset() {
     for(int i=1;i<7;i++) armlengths[i]->reset();
 }
 
+// the InterpolatedSignals share the LISASources, which hold all the state
+
+void CacheLengthLISA::savestate(FILE *file) {
+    if(physLISA != this) physLISA->savestate(file);
+
+    for(int i=1;i<7;i++) lisafuncs[i]->savestate(file);
+}
+
+void CacheLengthLISA::loadstate(FILE *file) {
+    if(physLISA != this) physLISA->loadstate(file);
+
+    for(int i=1;i<7;i++) lisafuncs[i]->loadstate(file);
+}
+
+// the armlength bisections are counted by basicLISA
+
+void CacheLengthLISA::addcounters(EventCounters &counters) {
+    if(physLISA != this) physLISA->getcounters(counters);
+    basicLISA->getcounters(counters);
+
+    for(int i=1;i<7;i++) lisafuncs[i]->getcounters(counters);
+
+    LISA::addcounters(counters);
+}
+
+void CacheLengthLISA::resetcounters() {
+    if(physLISA != this) physLISA->resetcounters();
+    basicLISA->resetcounters();
+
+    for(int i=1;i<7;i++) lisafuncs[i]->resetcounters();
+
+    LISA::resetcounters();
+}
+
 LISA* CacheLengthLISA::physlisa() {
     return physLISA;
 }
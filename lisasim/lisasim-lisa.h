@@ -47,6 +47,14 @@ static const double Lstd = 16.6782;
     with L = 5.0e9, e = 0.00964838. */
 static const double eccstd = 0.00964838;
 
+/** Symmetries of the delays, returned (or-ed together) by
+    LISA::delaysymmetry(): the armlengths do not depend on time (so
+    that delay operators commute), on the direction of propagation
+    (armlength(-arm) = armlength(arm)), or on the arm (for a given
+    direction). See simplifytable in lisasim-tdi.h. */
+
+enum { delaystatic = 1, delaysymmetric = 2, delayequal = 4 };
+
 /// Base LISA geometry class.
 
 
@@ -99,6 +107,9 @@ class LISA {
     double it, rt;
     double trb, tra;
 
+    /// Bisection iterations in the generic armlength().
+    long armiterations;
+
  protected:
     /** Initial armlength guess for the generic version of
 	armlength(). It should be initialized by the constructor of
@@ -108,16 +119,36 @@ class LISA {
 	void setguessL(double time = 0.0);
 
  public:
-    LISA() {};
+    LISA() : armiterations(0) {};
     virtual ~LISA() {};
 
     /// Resets LISA classes that have something to reset.
     virtual void reset() {};
 
+    /** Writes (reads back) the state of LISA classes that have
+	something to reset (see checkpointing in lisasim-signal.h). */
+    virtual void savestate(FILE *file) {};
+    virtual void loadstate(FILE *file) {};
+
+    /** Event counters (see lisasim-signal.h). Derived classes that
+	redefine addcounters and resetcounters should call the LISA
+	versions, which count the bisection iterations of the generic
+	armlength(). */
+    void getcounters(EventCounters &counters) {
+	if(counters.visit(this)) addcounters(counters);
+    };
+
+    virtual void addcounters(EventCounters &counters);
+    virtual void resetcounters();
+
     /** Returns a pointer to the TDI (nominal) LISA. Unless
 	overridden, returns just "this". */
     virtual LISA *physlisa() { return this; }
 
+    /** Returns the symmetries of the delays (see above); the
+	default, 0, makes no claims. */
+    virtual int delaysymmetry() { return 0; }
+
     /*  Fills n with the photon direction vector along "arm" for
 	reception at time t. */
     virtual void putn(Vector &n, int arm, double t);
@@ -188,6 +219,8 @@ class OriginalLISA : public LISA {
     virtual void putp(Vector &p, int craft, double t);
 	
     virtual double armlength(int arm, double t);
+
+    virtual int delaysymmetry();
 };
 
 
@@ -210,6 +243,8 @@ class ModifiedLISA : public OriginalLISA {
 
     double armlength(int arm, double t);
     double genarmlength(int arm, double t);
+
+    int delaysymmetry();
 };
 
 
@@ -269,6 +304,12 @@ class CircularRotating : public LISA, public ApproxLISA {
     double armlengthaccurate(int arm, double t);
 
     double genarmlength(int arm, double t);
+
+    // the rotating frame is carried along the orbit, so the armlengths
+    // oscillate in time (by R L Omega), differently for each arm and
+    // direction: no delay symmetries (ModifiedLISA has the static ones)
+
+    int delaysymmetry() { return 0; };
     
     double geteta0() {return eta0;};
     double getxi0() {return xi0;};
@@ -342,10 +383,12 @@ class EccentricInclined : public LISA, public ApproxLISA {
 
     double delmodph[4], delmodph2;
     
-    // caching the positions of spacecraft
+    // caching the positions of spacecraft; settimes counts recomputations
     
     Vector cachep[4];
     double cachetime[4];
+
+    long settimes;
     
     void settime(int craft,double t);
 
@@ -355,6 +398,9 @@ class EccentricInclined : public LISA, public ApproxLISA {
     EccentricInclined(double eta0 = 0.0,double xi0 = 0.0,double sw = 1.0,double t0 = 0.0);
     EccentricInclined(double myL,double eta0,double xi0,double sw,double t0);
 
+    void addcounters(EventCounters &counters);
+    void resetcounters();
+
     void putp(Vector &p,int craft,double t);
 
     // EccentricInclined defines a computed (leading order) version of armlength
@@ -385,6 +431,12 @@ class SampledLISA : public LISA {
     SampledLISA(double *sc1,long length1,double *sc2,long length2,double *sc3,long length3,double deltat,double prebuffer,int interplen = 1);    
     ~SampledLISA();
 
+    void savestate(FILE *file);
+    void loadstate(FILE *file);
+
+    void addcounters(EventCounters &counters);
+    void resetcounters();
+
     void putp(Vector &p,int craft,double t);
 };
 
@@ -431,6 +483,12 @@ class CacheLengthLISA : public LISA {
 
 	void reset(); 
 
+	void savestate(FILE *file);
+	void loadstate(FILE *file);
+
+	void addcounters(EventCounters &counters);
+	void resetcounters();
+
 	double armlength(int arm, double t);
 
 	double armlengthbaseline(int arm, double t);
@@ -450,53 +508,11 @@ class ZeroLISA : public OriginalLISA {
 
     double armlength(int arm, double t) {return 0.0;};
     double dotarmlength(int arm, double t) {return 0.0;};
-};
-
-
-// --- PyLISA ---
-
-#include <Python.h>
-
-class PyLISA : public LISA {
- private:
-    PyObject *armfunc;
-
- public: 
-    LISA *baseLISA;
 
-    PyLISA(LISA *base,PyObject *func) : armfunc(func), baseLISA(base) {};
-
-	void reset();
-
-	LISA *physlisa();
-
-    double armlength(int arm, double t);
-
-    double armlengthbaseline(int arm, double t);
-    double armlengthaccurate(int arm, double t);
-
-    void putn(Vector &n, int arm, double t);
-    void putp(Vector &p, int craft, double t);
+    int delaysymmetry() { return delaystatic | delaysymmetric | delayequal; };
 };
 
 
-class AllPyLISA : public LISA {
- private:
-    PyObject *craftfunc, *armlengthfunc;
-
- public: 
-    AllPyLISA(PyObject *cfunc,PyObject *afunc = 0);
-
-	void reset();
-
-    double armlength(int arm, double t);
-
-    double armlengthbaseline(int arm, double t);
-    double armlengthaccurate(int arm, double t);
-
-    void putp(Vector &p, int craft, double t);
-};
-
 #endif /* _LISASIM_LISA_H_ */
 
 
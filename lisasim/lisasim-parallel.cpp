@@ -0,0 +1,746 @@
+/* $Id$
+ * $Date$
+ * $Author$
+ * $Revision$
+ */
+
+#include "lisasim-parallel.h"
+#include "lisasim-tdinoise.h"
+#include "lisasim-tdi.h"
+#include "lisasim-except.h"
+#include "lisasim-profile.h"
+
+#include <pthread.h>
+#include <sys/time.h>
+
+#include <iostream>
+#include <deque>
+#include <vector>
+
+// errors caught in a worker thread are passed back to the main thread,
+// and rethrown there after all workers have joined
+
+enum { chunkok = 0, chunkoutofbounds, chunkundefined, chunkinterrupt, chunkcancelled, chunkerror };
+
+// state shared by all the workers of a run; after an error (or Ctrl-C
+// in the calling thread), stop tells the other workers to give up
+
+struct runcontrol {
+    long epoch;
+    volatile int stop;
+};
+
+// check for cancellation between batches (only the calling thread
+// looks at Python signals, see checkinterrupt in lisasim-tdi.cpp)
+
+const long parbatch = 16384;
+
+struct obschunk {
+    double *buffer;
+
+    long mini, maxi, warmup, offset;
+
+    double stime, inittime;
+
+    Signal **thesignals;
+    int signals;
+
+    runcontrol *control;
+    int python;
+
+    int error;
+};
+
+// to be called inside a catch block
+
+static int errorcode() {
+    try {
+        throw;
+    } catch (ExceptionOutOfBounds &e) {
+        return chunkoutofbounds;
+    } catch (ExceptionUndefined &e) {
+        return chunkundefined;
+    } catch (ExceptionKeyboardInterrupt &e) {
+        return chunkinterrupt;
+    } catch (ExceptionCancelled &e) {
+        return chunkcancelled;
+    } catch (...) {
+        return chunkerror;
+    }
+}
+
+static void rethrow(int error,const char *caller) {
+    if(error == chunkoutofbounds) {
+        ExceptionOutOfBounds e;
+        throw e;
+    } else if(error == chunkundefined) {
+        ExceptionUndefined e;
+        throw e;
+    } else if(error == chunkinterrupt) {
+        ExceptionKeyboardInterrupt e;
+        throw e;
+    } else if(error == chunkcancelled) {
+        ExceptionCancelled e;
+        throw e;
+    } else if(error != chunkok) {
+        std::cerr << caller << "(...): unexpected error in worker thread ["
+                  << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+        ExceptionUndefined e;
+        throw e;
+    }
+}
+
+// one row of observables at time t: through the fused evaluator when the
+// observables allow it (see fuseobservables), one by one otherwise
+
+static void evalrow(TDIfused *fused,Signal **signals,int count,double t,double *row) {
+    if(fused) {
+        fused->values(t,row);
+    } else {
+        for(int j=0;j<count;j++)
+            row[j] = signals[j]->value(t);
+    }
+}
+
+static void *runchunk(void *arg) {
+    obschunk *chunk = (obschunk *)arg;
+
+    TDIfused *fused = 0;
+
+    try {
+        fused = chunk->signals > 1 ? fuseobservables(chunk->thesignals,chunk->signals) : 0;
+        std::vector<double> discard(chunk->signals);
+
+        // rows are counted from inittime, but the buffer from offset; the
+        // warm-up may reach back into rows before offset (not before inittime)
+
+        long begi = chunk->mini - chunk->warmup > -chunk->offset ? chunk->mini - chunk->warmup : -chunk->offset;
+
+        for(long mini=begi;mini<chunk->maxi;mini+=parbatch) {
+            long maxi = (mini + parbatch) < chunk->maxi ? (mini + parbatch) : chunk->maxi;
+
+            for(long i=mini;i<maxi;i++) {
+                double t = chunk->inittime + chunk->stime * (chunk->offset + i);
+
+                // samples before mini are warm-up and are discarded
+
+                if(i < chunk->mini)
+                    evalrow(fused,chunk->thesignals,chunk->signals,t,&discard[0]);
+                else
+                    evalrow(fused,chunk->thesignals,chunk->signals,t,&chunk->buffer[i*chunk->signals]);
+            }
+
+            if(chunk->control->stop)
+                break;
+
+            checkinterrupt(chunk->control->epoch,chunk->python);
+        }
+    } catch (...) {
+        chunk->error = errorcode();
+        chunk->control->stop = 1;
+    }
+
+    delete fused;
+
+    return 0;
+}
+
+void fastgetobspar(double *buffer,long length,long samples,double stime,Signal **thesignals,int signals,int replicas,double inittime,long warmup,long offset) {
+    if(replicas < 1 || signals % replicas != 0) {
+        std::cerr << "fastgetobspar(...): the number of observables (" << signals
+                  << ") is not a multiple of the number of replicas (" << replicas
+                  << ") [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+        ExceptionWrongArguments e;
+        throw e;
+    }
+
+    int obs = signals / replicas;
+    long maxlength = length / obs < samples ? length / obs : samples;
+
+    // chunks of (nearly) equal length; the first few get one extra sample
+
+    obschunk *chunks = new obschunk[replicas];
+    pthread_t *threads = new pthread_t[replicas];
+
+    runcontrol control;
+    control.epoch = obsepoch();
+    control.stop = 0;
+
+    long mini = 0;
+
+    for(int r=0;r<replicas;r++) {
+        long chunklen = maxlength / replicas + (r < maxlength % replicas ? 1 : 0);
+
+        chunks[r].buffer = buffer;
+        chunks[r].mini = mini;
+        chunks[r].maxi = mini + chunklen;
+        chunks[r].warmup = warmup;
+        chunks[r].offset = offset;
+        chunks[r].stime = stime;
+        chunks[r].inittime = inittime;
+        chunks[r].thesignals = &thesignals[r*obs];
+        chunks[r].signals = obs;
+        chunks[r].control = &control;
+        chunks[r].python = 0;
+        chunks[r].error = chunkok;
+
+        mini += chunklen;
+    }
+
+    // run the first chunk in the calling thread if we cannot spawn more
+
+    int started = 0;
+
+    for(int r=1;r<replicas;r++) {
+        if(pthread_create(&threads[r],0,runchunk,&chunks[r]) != 0)
+            break;
+
+        started++;
+    }
+
+    chunks[0].python = 1;
+    runchunk(&chunks[0]);
+
+    for(int r=1;r<=started;r++)
+        pthread_join(threads[r],0);
+
+    for(int r=started+1;r<replicas && !control.stop;r++) {
+        chunks[r].python = 1;
+        runchunk(&chunks[r]);
+    }
+
+    int error = chunkok;
+
+    for(int r=0;r<replicas;r++)
+        if(chunks[r].error != chunkok) {
+            error = chunks[r].error;
+            break;
+        }
+
+    delete [] threads;
+    delete [] chunks;
+
+    rethrow(error,"fastgetobspar");
+}
+
+// --- scheduled observables ---
+
+// a lane is replica "replica" of group "group", covering chunks
+// firstchunk...endchunk-1, of which next is the next to run; a lane is
+// in at most one worker queue, or held by the worker running it
+
+struct obslane {
+    int group, replica;
+    long firstchunk, endchunk, next;
+};
+
+struct schedqueue {
+    std::deque<int> lanes;
+    pthread_mutex_t lock;
+};
+
+struct schedwork {
+    double *buffer;
+    long samples, chunk, chunks, warmup;
+    double stime, inittime;
+
+    Signal **thesignals;
+    int obs;
+
+    int *groupstart, *groupsizes;
+    double *costs;
+
+    obslane *lanes;
+    schedqueue *queues;
+    int worker, workers;
+
+    runcontrol *control;
+    int python;
+
+    int error;
+};
+
+static int poplane(schedqueue *queue,int back) {
+    int lane = -1;
+
+    pthread_mutex_lock(&queue->lock);
+
+    if(!queue->lanes.empty()) {
+        if(back) {
+            lane = queue->lanes.back();
+            queue->lanes.pop_back();
+        } else {
+            lane = queue->lanes.front();
+            queue->lanes.pop_front();
+        }
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+
+    return lane;
+}
+
+static void runtask(schedwork *work,obslane *lane) {
+    int g = lane->group;
+
+    Signal **signals = &work->thesignals[lane->replica * work->obs + work->groupstart[g]];
+    int count = work->groupsizes[g];
+
+    long mini = lane->next * work->chunk;
+    long maxi = mini + work->chunk < work->samples ? mini + work->chunk : work->samples;
+
+    long begin = profilenow();
+
+    TDIfused *fused = count > 1 ? fuseobservables(signals,count) : 0;
+
+    try {
+        // the first task of a lane evaluates (and discards) the warmup samples
+
+        if(lane->next == lane->firstchunk) {
+            std::vector<double> discard(count);
+
+            for(long i = (mini - work->warmup > 0 ? mini - work->warmup : 0);i<mini;i++)
+                evalrow(fused,signals,count,work->inittime + work->stime * i,&discard[0]);
+        }
+
+        double *row = work->buffer + mini * work->obs + work->groupstart[g];
+
+        for(long i=mini;i<maxi;i++,row+=work->obs)
+            evalrow(fused,signals,count,work->inittime + work->stime * i,row);
+    } catch (...) {
+        delete fused;
+        throw;
+    }
+
+    delete fused;
+
+    work->costs[g * work->chunks + lane->next] = 1.0e-9 * (profilenow() - begin);
+}
+
+static void *runsched(void *arg) {
+    schedwork *work = (schedwork *)arg;
+
+    try {
+        for(;;) {
+            int lane = poplane(&work->queues[work->worker],0);
+
+            // steal from the back of the other queues, nearest first
+
+            for(int v=1;lane < 0 && v<work->workers;v++)
+                lane = poplane(&work->queues[(work->worker + v) % work->workers],1);
+
+            // no waiting lanes anywhere: those still running cannot be split
+
+            if(lane < 0 || work->control->stop)
+                break;
+
+            runtask(work,&work->lanes[lane]);
+
+            // keep running the lane, but let other workers steal it
+
+            if(++work->lanes[lane].next < work->lanes[lane].endchunk) {
+                pthread_mutex_lock(&work->queues[work->worker].lock);
+                work->queues[work->worker].lanes.push_front(lane);
+                pthread_mutex_unlock(&work->queues[work->worker].lock);
+            }
+
+            checkinterrupt(work->control->epoch,work->python);
+        }
+    } catch (...) {
+        work->error = errorcode();
+        work->control->stop = 1;
+    }
+
+    return 0;
+}
+
+void fastgetobssched(double *buffer,long length,long samples,double stime,
+                     Signal **thesignals,int signals,int replicas,int *groupsizes,int groups,
+                     double *costs,long costlength,int threads,double inittime,
+                     long chunk,long warmup) {
+    int obs = (replicas >= 1 && signals % replicas == 0) ? signals / replicas : 0;
+
+    int grouped = 0;
+    for(int g=0;g<groups;g++) {
+        if(groupsizes[g] < 1) grouped = -1;
+        if(grouped >= 0) grouped += groupsizes[g];
+    }
+
+    long chunks = chunk >= 1 ? (samples + chunk - 1) / chunk : 0;
+
+    if(obs == 0 || grouped != obs || threads < 1 || chunk < 1 ||
+       length < samples * obs || costlength < groups * chunks) {
+        std::cerr << "fastgetobssched(...): need a multiple of replicas observables, divided "
+                  << "exactly into groups of at least one, threads >= 1, chunk >= 1, and output "
+                  << "arrays large enough for all samples and tasks ["
+                  << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+        ExceptionWrongArguments e;
+        throw e;
+    }
+
+    int *groupstart = new int[groups];
+
+    for(int g=0,start=0;g<groups;start+=groupsizes[g],g++)
+        groupstart[g] = start;
+
+    // lanes of (nearly) equal length, as in fastgetobspar, dealt to the
+    // workers in turn so that every worker starts with a mix of groups
+
+    int lanecount = groups * replicas;
+
+    obslane *lanes = new obslane[lanecount];
+    schedqueue *queues = new schedqueue[threads];
+
+    for(int w=0;w<threads;w++)
+        pthread_mutex_init(&queues[w].lock,0);
+
+    for(int g=0;g<groups;g++) {
+        long firstchunk = 0;
+
+        for(int r=0;r<replicas;r++) {
+            int l = g * replicas + r;
+            long lanelen = chunks / replicas + (r < chunks % replicas ? 1 : 0);
+
+            lanes[l].group = g;
+            lanes[l].replica = r;
+            lanes[l].firstchunk = lanes[l].next = firstchunk;
+            lanes[l].endchunk = firstchunk + lanelen;
+
+            if(lanelen > 0)
+                queues[l % threads].lanes.push_back(l);
+
+            firstchunk += lanelen;
+        }
+    }
+
+    runcontrol control;
+    control.epoch = obsepoch();
+    control.stop = 0;
+
+    schedwork *works = new schedwork[threads];
+    pthread_t *pthreads = new pthread_t[threads];
+
+    for(int w=0;w<threads;w++) {
+        works[w].buffer = buffer;
+        works[w].samples = samples;
+        works[w].chunk = chunk;
+        works[w].chunks = chunks;
+        works[w].warmup = warmup;
+        works[w].stime = stime;
+        works[w].inittime = inittime;
+        works[w].thesignals = thesignals;
+        works[w].obs = obs;
+        works[w].groupstart = groupstart;
+        works[w].groupsizes = groupsizes;
+        works[w].costs = costs;
+        works[w].lanes = lanes;
+        works[w].queues = queues;
+        works[w].worker = w;
+        works[w].workers = threads;
+        works[w].control = &control;
+        works[w].python = (w == 0);
+        works[w].error = chunkok;
+    }
+
+    // the lanes of workers that cannot be started are stolen by the others
+
+    int started = 0;
+
+    for(int w=1;w<threads;w++) {
+        if(pthread_create(&pthreads[w],0,runsched,&works[w]) != 0)
+            break;
+
+        started++;
+    }
+
+    runsched(&works[0]);
+
+    for(int w=1;w<=started;w++)
+        pthread_join(pthreads[w],0);
+
+    int error = chunkok;
+
+    for(int w=0;w<threads;w++)
+        if(works[w].error != chunkok) {
+            error = works[w].error;
+            break;
+        }
+
+    for(int w=0;w<threads;w++)
+        pthread_mutex_destroy(&queues[w].lock);
+
+    delete [] pthreads;
+    delete [] works;
+    delete [] queues;
+    delete [] lanes;
+    delete [] groupstart;
+
+    rethrow(error,"fastgetobssched");
+}
+
+// --- noise ensembles ---
+
+unsigned long ensembleseed(unsigned long seed,int stream) {
+    // consecutive seeds, as in WhiteNoiseSource's global-seed enumeration,
+    // starting from 1, since WhiteNoiseSource takes 0 to mean the global
+    // seed; they fit in 32 bits, so distinct (seed,stream) never collide
+
+    if(seed > maxensembleseed || stream < 0 || stream >= ensemblestreams) {
+        std::cerr << "ensembleseed(" << seed << "," << stream << "): need seed <= "
+                  << maxensembleseed << " and 0 <= stream < " << ensemblestreams
+                  << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+        ExceptionWrongArguments e;
+        throw e;
+    }
+
+    return 1UL + (unsigned long)ensemblestreams * seed + (unsigned long)stream;
+}
+
+struct ensemblework {
+    double *buffer;
+    long samples;
+    double stime, inittime;
+
+    LISA *lisa;
+
+    char **names;
+    int observables;
+
+    unsigned long *seeds;
+    int realizations;
+    double *rates;
+
+    double *noisepars;
+    int interp;
+
+    // shared realization counter
+
+    int *next;
+    pthread_mutex_t *lock;
+
+    runcontrol *control;
+    int python;
+
+    int error;
+};
+
+static Noise *ensemblenoise(LISA *lisa,double *noisepars,int interp,unsigned long seed,int stream) {
+    if(stream < 6)
+        return stdproofnoise(lisa,noisepars[0],noisepars[1],interp,ensembleseed(seed,stream));
+    else if(stream < 12)
+        return stdopticalnoise(lisa,noisepars[2],noisepars[3],interp,ensembleseed(seed,stream));
+    else
+        return stdlasernoise(lisa,noisepars[4],noisepars[5],interp,ensembleseed(seed,stream));
+}
+
+// with linear interpolation and a common sampling time, the 18 noises
+// are generated together (see NoiseBank); returns 0 otherwise
+
+static NoiseBank *ensemblebank(LISA *lisa,double *noisepars,unsigned long seed) {
+    double stproof[6], sdproof[6], stshot[6], sdshot[6], stlaser[6], sdlaser[6];
+    unsigned long seeds[ensemblestreams];
+
+    for(int i=0;i<6;i++) {
+        stproof[i] = noisepars[0]; sdproof[i] = noisepars[1];
+        stshot[i]  = noisepars[2]; sdshot[i]  = noisepars[3];
+        stlaser[i] = noisepars[4]; sdlaser[i] = noisepars[5];
+    }
+
+    for(int k=0;k<ensemblestreams;k++)
+        seeds[k] = ensembleseed(seed,k);
+
+    return stdnoisebank(lisa,stproof,sdproof,stshot,sdshot,stlaser,sdlaser,seeds);
+}
+
+static void *runensemble(void *arg) {
+    ensemblework *work = (ensemblework *)arg;
+
+    Noise *noises[ensemblestreams];
+    NoiseBank *bank = 0;
+    Signal **obs = new Signal*[work->observables];
+
+    for(int k=0;k<ensemblestreams;k++) noises[k] = 0;
+    for(int j=0;j<work->observables;j++) obs[j] = 0;
+
+    try {
+        for(;;) {
+            pthread_mutex_lock(work->lock);
+            int r = (*work->next)++;
+            pthread_mutex_unlock(work->lock);
+
+            if(r >= work->realizations || work->control->stop)
+                break;
+
+            struct timeval tv0, tv1;
+            gettimeofday(&tv0,0);
+
+            // every realization restarts from time zero
+
+            work->lisa->reset();
+
+            if(work->interp == 1)
+                bank = ensemblebank(work->lisa,work->noisepars,work->seeds[r]);
+
+            for(int k=0;k<ensemblestreams;k++)
+                noises[k] = bank ? bank->channel(k) : ensemblenoise(work->lisa,work->noisepars,work->interp,work->seeds[r],k);
+
+            TDInoise tdi(work->lisa,&noises[0],&noises[6],&noises[12]);
+
+            for(int j=0;j<work->observables;j++)
+                obs[j] = tdi.observable(work->names[j]);
+
+            double *slice = work->buffer + r * work->samples * work->observables;
+
+            for(long i=0;i<work->samples;i++) {
+                double t = work->inittime + work->stime * i;
+
+                for(int j=0;j<work->observables;j++)
+                    slice[i*work->observables + j] = obs[j]->value(t);
+
+                if((i+1) % parbatch == 0) {
+                    if(work->control->stop) break;
+                    checkinterrupt(work->control->epoch,work->python);
+                }
+            }
+
+            for(int j=0;j<work->observables;j++) {
+                delete obs[j]; obs[j] = 0;
+            }
+
+            for(int k=0;k<ensemblestreams;k++) {
+                delete noises[k]; noises[k] = 0;
+            }
+
+            delete bank; bank = 0;
+
+            gettimeofday(&tv1,0);
+
+            double elapsed = (tv1.tv_sec - tv0.tv_sec) + 1.0e-6 * (tv1.tv_usec - tv0.tv_usec);
+            work->rates[r] = elapsed > 0.0 ? work->samples / elapsed : 0.0;
+        }
+    } catch (...) {
+        work->error = errorcode();
+    }
+
+    // after an error, make the other threads stop
+
+    if(work->error != chunkok) {
+        work->control->stop = 1;
+
+        for(int j=0;j<work->observables;j++) delete obs[j];
+        for(int k=0;k<ensemblestreams;k++) delete noises[k];
+        delete bank;
+    }
+
+    delete [] obs;
+
+    return 0;
+}
+
+void fastgetensemble(double *buffer,long length,long samples,double stime,
+                     LISA **lisas,int threads,char **names,int observables,
+                     unsigned long *seeds,int realizations,double *rates,long ratelength,
+                     double *noisepars,int noisenum,int interp,double inittime) {
+    if(noisenum != 6 || threads < 1 || ratelength < realizations ||
+       length < realizations * samples * observables) {
+        std::cerr << "fastgetensemble(...): need six noise parameters, at least one LISA object, "
+                  << "and output arrays large enough for all realizations ["
+                  << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+        ExceptionWrongArguments e;
+        throw e;
+    }
+
+    for(int r=0;r<realizations;r++) {
+        if(seeds[r] > maxensembleseed) {
+            std::cerr << "fastgetensemble(...): realization seed " << seeds[r]
+                      << " is larger than " << maxensembleseed
+                      << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+            ExceptionWrongArguments e;
+            throw e;
+        }
+    }
+
+    // check the observable names before starting
+
+    TDI probe;
+
+    for(int j=0;j<observables;j++) {
+        TDIobject *obs = probe.observable(names[j]);
+
+        if(!obs) {
+            std::cerr << "fastgetensemble(...): unknown TDI observable " << names[j]
+                      << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+            ExceptionWrongArguments e;
+            throw e;
+        }
+
+        delete obs;
+    }
+
+    int next = 0;
+    pthread_mutex_t lock;
+    pthread_mutex_init(&lock,0);
+
+    runcontrol control;
+    control.epoch = obsepoch();
+    control.stop = 0;
+
+    ensemblework *works = new ensemblework[threads];
+    pthread_t *pthreads = new pthread_t[threads];
+
+    for(int w=0;w<threads;w++) {
+        works[w].buffer = buffer;
+        works[w].samples = samples;
+        works[w].stime = stime;
+        works[w].inittime = inittime;
+        works[w].lisa = lisas[w];
+        works[w].names = names;
+        works[w].observables = observables;
+        works[w].seeds = seeds;
+        works[w].realizations = realizations;
+        works[w].rates = rates;
+        works[w].noisepars = noisepars;
+        works[w].interp = interp;
+        works[w].next = &next;
+        works[w].lock = &lock;
+        works[w].control = &control;
+        works[w].python = (w == 0);
+        works[w].error = chunkok;
+    }
+
+    int started = 0;
+
+    for(int w=1;w<threads;w++) {
+        if(pthread_create(&pthreads[w],0,runensemble,&works[w]) != 0)
+            break;
+
+        started++;
+    }
+
+    runensemble(&works[0]);
+
+    for(int w=1;w<=started;w++)
+        pthread_join(pthreads[w],0);
+
+    pthread_mutex_destroy(&lock);
+
+    int error = chunkok;
+
+    for(int w=0;w<threads;w++)
+        if(works[w].error != chunkok) {
+            error = works[w].error;
+            break;
+        }
+
+    delete [] pthreads;
+    delete [] works;
+
+    rethrow(error,"fastgetensemble");
+}
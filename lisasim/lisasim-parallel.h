@@ -0,0 +1,78 @@
+/* $Id$
+ * $Date$
+ * $Author$
+ * $Revision$
+ */
+
+#ifndef _LISASIM_PARALLEL_H_
+#define _LISASIM_PARALLEL_H_
+
+#include "lisasim-signal.h"
+#include "lisasim-lisa.h"
+
+/* Parallel version of fastgetobs. The output time range is divided into
+   "replicas" contiguous chunks, each computed by a separate thread on its
+   own replica of the observables (since LISA, Noise, and TDI objects keep
+   mutable ring buffers and caches, they cannot be shared between threads).
+
+   thesignals holds replicas x (signals/replicas) pointers, ordered by
+   replica. Each replica must be built identically (same LISA, same noise
+   seeds) for the output to match fastgetobs: its buffered noise sources
+   regenerate the full pseudorandom history from their first sample, and
+   each worker also evaluates (and discards) "warmup" samples before the
+   beginning of its chunk. Row i of buffer is taken at time
+   inittime + stime*(offset + i), so that a long run can be computed in
+   blocks with the same sample times (to the bit) as a single call. */
+
+extern void fastgetobspar(double *buffer,long length,long samples,double stime,Signal **thesignals,int signals,int replicas,double inittime,long warmup = 0,long offset = 0);
+
+/* Scheduled version of fastgetobspar, for observables of very different
+   cost (e.g., TDIsignal observables for many sources next to cheap
+   TDInoise combinations). The observables of each replica are divided
+   into "groups" consecutive groups (groupsizes[g] observables in group g),
+   and the time range into chunks of "chunk" samples; each (group, chunk)
+   pair is a task. Since observables are stateful, the tasks of a group
+   are run in order on each replica: replica r of group g takes a
+   contiguous range of chunks (a "lane", as in fastgetobspar, with warmup
+   samples evaluated before its first chunk). Lanes are dealt to
+   "threads" workers, which run them task by task; a worker that runs out
+   of lanes steals a waiting lane from the back of another worker's queue.
+
+   Observables in different groups of the same replica must not share
+   LISA, Noise, or TDI objects, since they may be evaluated concurrently.
+   The wall-clock cost (in seconds) of task (g,c) is written to
+   costs[g*chunks + c], where chunks = ceil(samples/chunk); the cost of
+   warmup is charged to the first task of each lane. */
+
+extern void fastgetobssched(double *buffer,long length,long samples,double stime,
+                            Signal **thesignals,int signals,int replicas,int *groupsizes,int groups,
+                            double *costs,long costlength,int threads,double inittime,
+                            long chunk = 16384,long warmup = 0);
+
+/* Monte Carlo noise ensembles. Each realization is a TDInoise object with
+   standard proof-mass, optical-path, and laser noises (noisepars holds
+   stproof, sdproof, stshot, sdshot, stlaser, sdlaser, as in the TDInoise
+   constructor); the 18 noises of the realization with seed s are seeded
+   with ensembleseed(s,k) = 1 + 18*s + k (s must not exceed
+   maxensembleseed), where k = 0-5 for proof-mass noises, 6-11 for
+   optical-path noises, and 12-17 for laser noises, in the order of the
+   TDInoise(lisa,proofnoise[6],shotnoise[6],lasernoise[6]) constructor.
+   Realizations are run on "threads" threads, each using its own LISA
+   object from lisas; the observables (named as in TDI::observable) of
+   realization r are written to buffer[r*samples*observables ...], and
+   its throughput (samples/s) to rates[r]. */
+
+const int ensemblestreams = 18;
+
+// ensemble seeds are 1 + 18*s + k, which must fit in 32 bits
+
+const unsigned long maxensembleseed = (0xffffffffUL - ensemblestreams) / ensemblestreams;
+
+extern unsigned long ensembleseed(unsigned long seed,int stream);
+
+extern void fastgetensemble(double *buffer,long length,long samples,double stime,
+                            LISA **lisas,int threads,char **names,int observables,
+                            unsigned long *seeds,int realizations,double *rates,long ratelength,
+                            double *noisepars,int noisenum,int interp = 1,double inittime = 0.0);
+
+#endif /* _LISASIM_PARALLEL_H_ */
@@ -0,0 +1,75 @@
+/* $Id$
+ * $Date$
+ * $Author$
+ * $Revision$
+ */
+
+#include "lisasim-profile.h"
+
+#include <time.h>
+#include <iostream>
+
+int profileenabled = 0;
+
+static volatile long stagecalls[profilestages];
+static volatile long stagetimes[profilestages];
+
+static const char *stagenames[profilestages] = {
+    "WhiteNoiseSource::getvalue",
+    "SignalFilter::getvalue",
+    "Interpolator::getvalue",
+    "LISA::armlength",
+    "CacheLISA::retard",
+    "TDIsignal::psi",
+    "NoiseBank::advance"
+};
+
+int profilecompiled() {
+#ifdef SYNTHLISA_PROFILE
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+void setprofile(int enable) {
+    if(enable && !profilecompiled()) {
+        std::cerr << "setprofile(int): profiling not compiled in (use setup.py --with-profile)"
+                  << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+    }
+
+    profileenabled = enable;
+}
+
+void resetprofile() {
+    for(int i=0;i<profilestages;i++) {
+        stagecalls[i] = 0;
+        stagetimes[i] = 0;
+    }
+}
+
+const char *profilename(int stage) {
+    return (stage >= 0 && stage < profilestages) ? stagenames[stage] : 0;
+}
+
+long profilecalls(int stage) {
+    return (stage >= 0 && stage < profilestages) ? stagecalls[stage] : 0;
+}
+
+double profiletime(int stage) {
+    return (stage >= 0 && stage < profilestages) ? 1.0e-9 * stagetimes[stage] : 0.0;
+}
+
+// several threads may be running simulations at the same time
+
+void profileadd(int stage,long nanoseconds,long calls) {
+    __sync_fetch_and_add(&stagecalls[stage],calls);
+    __sync_fetch_and_add(&stagetimes[stage],nanoseconds);
+}
+
+long profilenow() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+
+    return 1000000000L * ts.tv_sec + ts.tv_nsec;
+}
@@ -0,0 +1,69 @@
+/* $Id$
+ * $Date$
+ * $Author$
+ * $Revision$
+ */
+
+#ifndef _LISASIM_PROFILE_H_
+#define _LISASIM_PROFILE_H_
+
+/* Opt-in profiler for the main stages of a simulation. It is compiled in
+   only if SYNTHLISA_PROFILE is defined (python setup.py --with-profile),
+   and then it must still be turned on with setprofile(1). Each stage
+   accumulates the number of calls and the (inclusive) wall time spent
+   in them; since stages nest (e.g., CacheLISA::retard calls the LISA
+   armlength functions), times do not add up to the total. Stages that
+   work in batches (NoiseBank::advance) count the samples they produce
+   instead of the calls, so that they compare with per-sample stages. */
+
+enum {
+    profilewhitenoise = 0,      // WhiteNoiseSource::getvalue
+    profilefilter,              // SignalFilter::getvalue
+    profileinterpolator,        // Interpolator::getvalue (in InterpolatedSignal)
+    profilearmlength,           // LISA armlength functions (from retard)
+    profileretard,              // CacheLISA::retard
+    profilepsi,                 // TDIsignal::psi
+    profilenoisebank,           // NoiseBank::advance (counts samples, all channels)
+    profilestages
+};
+
+extern int profileenabled;
+
+extern int profilecompiled();
+
+extern void setprofile(int enable);
+extern void resetprofile();
+
+extern const char *profilename(int stage);
+extern long profilecalls(int stage);
+extern double profiletime(int stage);
+
+extern void profileadd(int stage,long nanoseconds,long calls = 1);
+extern long profilenow();
+
+#ifdef SYNTHLISA_PROFILE
+
+class ProfileScope {
+ private:
+    int stage;
+    long calls, begin;
+
+ public:
+    ProfileScope(int s,long c = 1) : stage(s), calls(c), begin(profileenabled ? profilenow() : -1) {}
+
+    ~ProfileScope() {
+        if(begin >= 0) profileadd(stage,profilenow() - begin,calls);
+    }
+};
+
+#define PROFILESTAGE(stage) ProfileScope _profilescope(stage)
+#define PROFILESAMPLES(stage,samples) ProfileScope _profilescope(stage,samples)
+
+#else
+
+#define PROFILESTAGE(stage)
+#define PROFILESAMPLES(stage,samples)
+
+#endif
+
+#endif /* _LISASIM_PROFILE_H_ */
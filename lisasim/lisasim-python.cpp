@@ -0,0 +1,149 @@
+/* $Id$
+ * $Date$
+ * $Author$
+ * $Revision$
+ */
+
+#include "lisasim-python.h"
+#include "lisasim-except.h"
+
+#include <iostream>
+
+
+// --- PyLISA ---
+
+void PyLISA::reset() {
+	return baseLISA->reset();
+}
+
+LISA* PyLISA::physlisa() {
+	return baseLISA;
+}
+
+double PyLISA::armlength(int arm, double t) {
+	PyObject *arglist, *result;
+  
+	double dres = 0.0;
+	
+	// fastgetobs may have released the Python interpreter lock
+
+	PyGILState_STATE gstate = PyGILState_Ensure();
+
+	arglist = Py_BuildValue("(id)",arm,t);        // Build argument list
+	result = PyEval_CallObject(armfunc,arglist);  // Call Python
+	Py_DECREF(arglist);                           // Trash arglist
+	if (result) dres = PyFloat_AsDouble(result);  // If no errors, return double
+	Py_XDECREF(result);                           // Trash result
+
+	PyGILState_Release(gstate);
+	return dres;
+}
+
+double PyLISA::armlengthbaseline(int arm, double t) {
+	return armlength(arm,t);
+}
+
+double PyLISA::armlengthaccurate(int arm, double t) {
+	return 0.0;
+}
+
+void PyLISA::putn(Vector &n, int arm, double t) {
+	baseLISA->putn(n,arm,t);
+}
+    
+void PyLISA::putp(Vector &p, int craft, double t) {
+	baseLISA->putp(p,craft,t);
+}
+
+// --- AllPyLISA ---
+
+// problem here: setLguesses needs the virtual putp, which may not be ready
+
+AllPyLISA::AllPyLISA(PyObject *cfunc,PyObject *afunc) : craftfunc(cfunc), armlengthfunc(afunc) {
+	setguessL();
+}
+
+void AllPyLISA::reset() {
+	setguessL();
+}
+
+double AllPyLISA::armlength(int arm, double t) {
+	if (armlengthfunc != 0) {
+		PyObject *arglist, *result;
+    
+		double dres = 0.0;
+    
+		PyGILState_STATE gstate = PyGILState_Ensure();
+
+		arglist = Py_BuildValue("(id)",arm,t);              // Build argument list
+		result = PyEval_CallObject(armlengthfunc,arglist);  // Call Python
+		Py_DECREF(arglist);                                 // Trash arglist
+		if (result) dres = PyFloat_AsDouble(result);        // If no errors, return double
+		// no type checking!
+		Py_XDECREF(result);                                 // Trash result
+
+		PyGILState_Release(gstate);
+		return dres;
+	} else {
+		return LISA::armlength(arm,t);
+	}
+}
+
+double AllPyLISA::armlengthbaseline(int arm, double t) {
+	return armlength(arm,t);
+}
+
+double AllPyLISA::armlengthaccurate(int arm, double t) {
+	return 0.0;
+}
+    
+void AllPyLISA::putp(Vector &p, int craft, double t) {
+	PyObject *arglist, *result;
+
+	PyGILState_STATE gstate = PyGILState_Ensure();
+        
+	arglist = Py_BuildValue("(id)",craft,t);        // Build argument list
+	result = PyEval_CallObject(craftfunc,arglist);  // Call Python
+	Py_DECREF(arglist);                             // Trash arglist
+	if (result) {                                   // If no errors, get results
+		p[0] = PyFloat_AsDouble(PyTuple_GetItem(result,0));
+		p[1] = PyFloat_AsDouble(PyTuple_GetItem(result,1));
+		p[2] = PyFloat_AsDouble(PyTuple_GetItem(result,2));
+	}
+	Py_XDECREF(result);                             // Trash result
+
+	PyGILState_Release(gstate);
+}
+
+
+// --- Python signals ---
+
+int pythoninterrupt() {
+    if(!Py_IsInitialized())
+        return 0;
+
+    // the SWIG wrappers release the Python interpreter lock while
+    // fastgetobs runs, so we need to take it back to look for signals
+
+    PyGILState_STATE gstate = PyGILState_Ensure();
+    int signals = PyErr_CheckSignals();
+    PyGILState_Release(gstate);
+
+    return signals != 0;
+}
+
+
+// --- event counters ---
+
+PyObject *counterdict(EventCounters &counters) {
+    PyObject *dict = PyDict_New();
+
+    for(unsigned int i=0;i<counters.names.size();i++) {
+        PyObject *value = PyInt_FromLong(counters.values[i]);
+
+        PyDict_SetItemString(dict,counters.names[i],value);
+        Py_DECREF(value);
+    }
+
+    return dict;
+}
@@ -0,0 +1,134 @@
+/* $Id$
+ * $Date$
+ * $Author$
+ * $Revision$
+ */
+
+#ifndef _LISASIM_PYTHON_H_
+#define _LISASIM_PYTHON_H_
+
+/* The Python layer: LISA and Wave classes that call back into Python
+   functions, and the check for Python signals (e.g., Ctrl-C) used by
+   the fastgetobs functions. This is the only part of Synthetic LISA that
+   needs Python.h; the rest of the library builds and links without
+   Python (see --make-clib in setup.py). */
+
+#include <Python.h>
+
+#include "lisasim-lisa.h"
+#include "lisasim-wave.h"
+
+// --- PyLISA ---
+
+class PyLISA : public LISA {
+ private:
+    PyObject *armfunc;
+
+ public: 
+    LISA *baseLISA;
+
+    PyLISA(LISA *base,PyObject *func) : armfunc(func), baseLISA(base) {};
+
+	void reset();
+
+	void savestate(FILE *file) { baseLISA->savestate(file); };
+	void loadstate(FILE *file) { baseLISA->loadstate(file); };
+
+	void addcounters(EventCounters &counters) {
+		LISA::addcounters(counters);
+		baseLISA->getcounters(counters);
+	};
+
+	void resetcounters() {
+		LISA::resetcounters();
+		baseLISA->resetcounters();
+	};
+
+	LISA *physlisa();
+
+    double armlength(int arm, double t);
+
+    double armlengthbaseline(int arm, double t);
+    double armlengthaccurate(int arm, double t);
+
+    void putn(Vector &n, int arm, double t);
+    void putp(Vector &p, int craft, double t);
+};
+
+
+class AllPyLISA : public LISA {
+ private:
+    PyObject *craftfunc, *armlengthfunc;
+
+ public: 
+    AllPyLISA(PyObject *cfunc,PyObject *afunc = 0);
+
+	void reset();
+
+    double armlength(int arm, double t);
+
+    double armlengthbaseline(int arm, double t);
+    double armlengthaccurate(int arm, double t);
+
+    void putp(Vector &p, int craft, double t);
+};
+
+
+// --- PyWave ---
+
+class PyWave : public Wave {
+ private:
+    PyObject *hpfunc, *hcfunc;
+
+ public:
+    PyWave(PyObject *hpf, PyObject *hcf, double b, double l, double p)
+		: Wave(b,l,p), hpfunc(hpf), hcfunc(hcf) {};
+    virtual ~PyWave() {};
+
+    double hp(double t) {
+		PyObject *arglist, *result;
+
+		double dres = 0.0;
+
+		PyGILState_STATE gstate = PyGILState_Ensure();
+
+		arglist = Py_BuildValue("(d)",t);             // Build argument list
+		result = PyEval_CallObject(hpfunc,arglist);  // Call Python
+		Py_DECREF(arglist);                           // Trash arglist
+		if (result) dres = PyFloat_AsDouble(result);  // If no errors, return double
+		Py_XDECREF(result);                           // Trash result
+
+		PyGILState_Release(gstate);
+		return dres;
+    }
+
+    double hc(double t) {
+		PyObject *arglist, *result;
+
+		double dres = 0.0;
+
+		PyGILState_STATE gstate = PyGILState_Ensure();
+
+		arglist = Py_BuildValue("(d)",t);             // Build argument list
+		result = PyEval_CallObject(hcfunc,arglist);  // Call Python
+		Py_DECREF(arglist);                           // Trash arglist
+		if (result) dres = PyFloat_AsDouble(result);  // If no errors, return double
+		Py_XDECREF(result);                           // Trash result
+
+		PyGILState_Release(gstate);
+		return dres;
+    }
+};
+
+
+// checks Python signals (taking back the interpreter lock that the SWIG
+// wrappers release); installed with setinterrupthook (see lisasim-tdi.h)
+// when the Python module is loaded
+
+extern int pythoninterrupt();
+
+// the counters as a Python dictionary
+
+extern PyObject *counterdict(EventCounters &counters);
+
+#endif /* _LISASIM_PYTHON_H_ */
@@ -5,6 +5,7 @@
  */
 
 #include "lisasim-retard.h"
+#include "lisasim-profile.h"
 
 CacheLISA::CacheLISA(LISA *l) : basiclisa(l) {
    for(unsigned int i=0;i<buflength;i++) {
@@ -16,6 +17,8 @@ CacheLISA::CacheLISA(LISA *l) : basiclisa(l) {
    }
 
    newretardtime(0.0);
+
+   resetcounters();
 }
 
 void CacheLISA::reset() {
@@ -29,6 +32,68 @@ void CacheLISA::reset() {
    basiclisa->reset();
 }
 
+void CacheLISA::savestate(FILE *file) {
+   savebytes(file,&it,sizeof(double)); savebytes(file,&rt,sizeof(double));
+   savebytes(file,&trb,sizeof(double)); savebytes(file,&tra,sizeof(double));
+   savebytes(file,&rts,sizeof(unsigned long)); savebytes(file,&hash,sizeof(unsigned long));
+   savebytes(file,&lastarm,sizeof(int));
+
+   savebytes(file,keys,sizeof(keys));
+   savebytes(file,its,sizeof(its)); savebytes(file,rtis,sizeof(rtis));
+   savebytes(file,trbs,sizeof(trbs)); savebytes(file,tras,sizeof(tras));
+
+   savebytes(file,pts,sizeof(pts)); savebytes(file,pis,sizeof(pis));
+
+   for(unsigned int i=0;i<buflength;i++) {
+       double p[3] = {ps[i][0], ps[i][1], ps[i][2]};
+       savebytes(file,p,sizeof(p));
+   }
+
+   basiclisa->savestate(file);
+}
+
+void CacheLISA::loadstate(FILE *file) {
+   loadbytes(file,&it,sizeof(double)); loadbytes(file,&rt,sizeof(double));
+   loadbytes(file,&trb,sizeof(double)); loadbytes(file,&tra,sizeof(double));
+   loadbytes(file,&rts,sizeof(unsigned long)); loadbytes(file,&hash,sizeof(unsigned long));
+   loadbytes(file,&lastarm,sizeof(int));
+
+   loadbytes(file,keys,sizeof(keys));
+   loadbytes(file,its,sizeof(its)); loadbytes(file,rtis,sizeof(rtis));
+   loadbytes(file,trbs,sizeof(trbs)); loadbytes(file,tras,sizeof(tras));
+
+   loadbytes(file,pts,sizeof(pts)); loadbytes(file,pis,sizeof(pis));
+
+   for(unsigned int i=0;i<buflength;i++) {
+       double p[3];
+       loadbytes(file,p,sizeof(p));
+       ps[i][0] = p[0]; ps[i][1] = p[1]; ps[i][2] = p[2];
+   }
+
+   basiclisa->loadstate(file);
+}
+
+void CacheLISA::addcounters(EventCounters &counters) {
+   counters.add("retard-hits",retardhits);
+   counters.add("retard-misses",retardmisses);
+   counters.add("retard-collisions",retardcollisions);
+   counters.add("putp-hits",putphits);
+   counters.add("putp-misses",putpmisses);
+
+   LISA::addcounters(counters);
+
+   basiclisa->getcounters(counters);
+}
+
+void CacheLISA::resetcounters() {
+   retardhits = retardmisses = retardcollisions = 0;
+   putphits = putpmisses = 0;
+
+   LISA::resetcounters();
+
+   basiclisa->resetcounters();
+}
+
 void CacheLISA::newretardtime(double t) {
    it = t; rt = t;
    trb = 0.0; tra = 0.0;
@@ -47,6 +112,8 @@ double CacheLISA::retardation() {
 void CacheLISA::retard(int ret) {
     if(ret == 0) return;
 
+    PROFILESTAGE(profileretard);
+
     // Update the retardation key and the hash.
     if(rts == 0) {
         rts = ret > 0 ? ret : (4 | -ret);
@@ -80,6 +147,8 @@ void CacheLISA::retard(int ret) {
 
         rt = rtis[hash];
         trb = trbs[hash]; tra = tras[hash];
+
+        retardhits++;
     } else {
         // Nah, will have to compute it.
 
@@ -87,8 +156,12 @@ void CacheLISA::retard(int ret) {
         // printf("Getting arm %d at time %f\n",ret,rt);
         // printf("rts %d hash %d ",rts,hash);
 
-        trb += basiclisa->armlengthbaseline(ret,rt);
-        tra += basiclisa->armlengthaccurate(ret,rt);
+        {
+            PROFILESTAGE(profilearmlength);
+
+            trb += basiclisa->armlengthbaseline(ret,rt);
+            tra += basiclisa->armlengthaccurate(ret,rt);
+        }
 	
         rt = (it - trb) - tra;
 
@@ -96,6 +169,9 @@ void CacheLISA::retard(int ret) {
 
         // note: in case of cache collisions, we're overwriting the cache
 
+        retardmisses++;
+        if(its[hash] == it && keys[hash] != 0) retardcollisions++;
+
         its[hash] = it;
         keys[hash] = rts;
 
@@ -108,6 +184,8 @@ void CacheLISA::retard(LISA *anotherlisa,int ret) {
     if (anotherlisa == basiclisa) {
         retard(ret);
     } else if (ret != 0) {
+        PROFILESTAGE(profilearmlength);
+
         trb += anotherlisa->armlengthbaseline(ret,rt);  
         tra += anotherlisa->armlengthaccurate(ret,rt);
 
@@ -122,10 +200,14 @@ void CacheLISA::putp(Vector &p, int craft, double t) {
         // printf("found!\n");
 
         p[0] = ps[hash][0]; p[1] = ps[hash][1]; p[2] = ps[hash][2];
+
+        putphits++;
     } else {
         // printf("no, have %f,%d\n",pts[hash],pis[hash]);
 
         basiclisa->putp(p,craft,t);
+
+        putpmisses++;
         
         pts[hash] = t;
         pis[hash] = craft;
@@ -74,6 +74,12 @@ class CacheLISA : public LISA {
     
     Vector ps[buflength];
 
+    /** Event counters: cached and computed retardations, computed
+	retardations that overwrite a different retardation for the same
+	time (hash collisions), cached and computed positions. */
+    long retardhits, retardmisses, retardcollisions;
+    long putphits, putpmisses;
+
  public:
     /// Default constructor. Sets caches and counters to zero.
     CacheLISA(LISA *l);
@@ -81,10 +87,20 @@ class CacheLISA : public LISA {
     /// Reset function. Sets caches and counters to zero, and calls reset for basiclisa.
     void reset();
 
+    /// Checkpointing: saves (restores) caches and counters, and the state of basiclisa.
+    void savestate(FILE *file);
+    void loadstate(FILE *file);
+
+    /// Counters (see lisasim-signal.h), including those of basiclisa.
+    void addcounters(EventCounters &counters);
+    void resetcounters();
+
     // The following is all standard for "encapsulating" LISA objects.
 
     LISA *physlisa() { return basiclisa->physlisa(); };
 
+    int delaysymmetry() { return basiclisa->delaysymmetry(); };
+
     double armlength(int arm, double t) { return basiclisa->armlength(arm,t); };
 
     double armlengthbaseline(int arm, double t) { return basiclisa->armlengthbaseline(arm,t); };
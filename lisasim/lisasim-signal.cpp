@@ -6,12 +6,77 @@
 
 #include "lisasim-signal.h"
 #include "lisasim-except.h"
+#include "lisasim-profile.h"
 
 #include <iostream>
 #include <cmath>
+#include <string.h>
 
 #include <sys/time.h>
 
+// --- checkpointing helpers ---
+
+void savebytes(FILE *file,const void *data,size_t size) {
+	if(size > 0 && fwrite(data,1,size,file) != size) {
+		std::cerr << "savebytes(...): cannot write checkpoint state ["
+		          << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+		ExceptionFileError e;
+		throw e;
+	}
+}
+
+void loadbytes(FILE *file,void *data,size_t size) {
+	if(size > 0 && fread(data,1,size,file) != size) {
+		std::cerr << "loadbytes(...): truncated checkpoint state ["
+		          << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+		ExceptionFileError e;
+		throw e;
+	}
+}
+
+// sizes are saved with the state, and checked against those of the
+// object being restored, to catch checkpoints from a different setup
+
+void loadcheck(FILE *file,long value,const char *what) {
+	long saved;
+
+	loadbytes(file,&saved,sizeof(long));
+
+	if(saved != value) {
+		std::cerr << "loadcheck(...): checkpoint " << what << " (" << saved
+		          << ") does not match current object (" << value << ") ["
+		          << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+		ExceptionFileError e;
+		throw e;
+	}
+}
+
+
+// --- EventCounters ---
+
+int EventCounters::visit(const void *obj) {
+	for(unsigned int i=0;i<visited.size();i++)
+		if(visited[i] == obj) return 0;
+
+	visited.push_back(obj);
+	return 1;
+}
+
+void EventCounters::add(const char *name,long value) {
+	for(unsigned int i=0;i<names.size();i++)
+		if(!strcmp(names[i],name)) {
+			values[i] += value;
+			return;
+		}
+
+	names.push_back(name);
+	values.push_back(value);
+}
+
+
 // --- RingBuffer ---
 
 RingBuffer::RingBuffer(long len)
@@ -25,14 +90,24 @@ RingBuffer::~RingBuffer() {
 }
 
 void RingBuffer::reset() {
-	for(int i=0;i<length;i++) data[i] = 0.0;
+	for(long i=0;i<length;i++) data[i] = 0.0;
+}
+
+void RingBuffer::savestate(FILE *file) {
+	savebytes(file,&length,sizeof(long));
+	savebytes(file,data,length*sizeof(double));
+}
+
+void RingBuffer::loadstate(FILE *file) {
+	loadcheck(file,length,"buffer length");
+	loadbytes(file,data,length*sizeof(double));
 }
 
 
 // --- BufferedSignalSource ---
 
 BufferedSignalSource::BufferedSignalSource(long len)
-	: buffer(len), length(len), current(-1) {}
+	: buffer(len), length(len), current(-1), generated(0), reread(0), nearstale(0) {}
 
 void BufferedSignalSource::reset(unsigned long seed) {
 	buffer.reset();
@@ -48,18 +123,45 @@ double BufferedSignalSource::operator[](long pos) {
 		ExceptionOutOfBounds e;
 		throw e;
 	} else if (pos > current) {
-		for(int i=current+1;i<=pos;i++) {
+		generated += pos - current;
+
+		// advance current as we go, so that recursive filters
+		// (which read back their own output at i-1) find it buffered
+
+		for(long i=current+1;i<=pos;i++) {
 			buffer[i] = getvalue(i);
+			current = i;
 		}
-		
-		current = pos;
 
 		return buffer[pos];
 	} else {
+		reread++;
+		if(pos <= current - length + length/8) nearstale++;
+
 		return buffer[pos];
 	}
 }
 
+void BufferedSignalSource::addcounters(EventCounters &counters) {
+	counters.add("samples-generated",generated);
+	counters.add("samples-reread",reread);
+	counters.add("stale-near-misses",nearstale);
+}
+
+void BufferedSignalSource::resetcounters() {
+	generated = reread = nearstale = 0;
+}
+
+void BufferedSignalSource::savestate(FILE *file) {
+	savebytes(file,&current,sizeof(long));
+	buffer.savestate(file);
+}
+
+void BufferedSignalSource::loadstate(FILE *file) {
+	loadbytes(file,&current,sizeof(long));
+	buffer.loadstate(file);
+}
+
 
 // --- WhiteNoiseSource ---
 
@@ -96,16 +198,18 @@ unsigned long WhiteNoiseSource::getglobalseed() {
 	return globalseed;
 }
 
+unsigned long WhiteNoiseSource::nextseed() {
+	unsigned long seed = getglobalseed();
+
+	// should replace this simple seed enumeration
+	// with something a bit more sophisticated
+	globalseed += 1;
+
+	return seed;
+}
+
 void WhiteNoiseSource::seedrandgen(unsigned long seed) {
-    if (seed == 0) {
-		gsl_rng_set(randgen,getglobalseed());
-		
-		// should replace this simple seed enumeration
-		// with something a bit more sophisticated
-		globalseed += 1;
-    } else {
-		gsl_rng_set(randgen,seed);
-    }
+	gsl_rng_set(randgen,seed == 0 ? nextseed() : seed);
 
     cacheset = 0;
     cacherand = 0;
@@ -117,6 +221,30 @@ void WhiteNoiseSource::reset(unsigned long seed) {
 	BufferedSignalSource::reset(seed);
 }
 
+// the raw generator state is portable only between identical builds
+
+void WhiteNoiseSource::savestate(FILE *file) {
+	long size = gsl_rng_size(randgen);
+
+	savebytes(file,&size,sizeof(long));
+	savebytes(file,gsl_rng_state(randgen),size);
+
+	savebytes(file,&cacheset,sizeof(int));
+	savebytes(file,&cacherand,sizeof(double));
+
+	BufferedSignalSource::savestate(file);
+}
+
+void WhiteNoiseSource::loadstate(FILE *file) {
+	loadcheck(file,gsl_rng_size(randgen),"generator state size");
+	loadbytes(file,gsl_rng_state(randgen),gsl_rng_size(randgen));
+
+	loadbytes(file,&cacheset,sizeof(int));
+	loadbytes(file,&cacherand,sizeof(double));
+
+	BufferedSignalSource::loadstate(file);
+}
+
 /* Box-Muller transform to get Gaussian deviate from uniform random,
    number, adapted from GSL 1.4 randist/gauss.c
 
@@ -124,6 +252,8 @@ void WhiteNoiseSource::reset(unsigned long seed) {
    within a buffered environment */
 
 double WhiteNoiseSource::getvalue(long pos) {
+  PROFILESTAGE(profilewhitenoise);
+
   double x, y, r2;
 
   if (cacheset == 0) {
@@ -163,6 +293,30 @@ void ResampledSignalSource::reset(unsigned long seed) {
 	BufferedSignalSource::reset(seed);
 }
 
+void ResampledSignalSource::savestate(FILE *file) {
+	signal->savestate(file);
+
+	BufferedSignalSource::savestate(file);
+}
+
+void ResampledSignalSource::loadstate(FILE *file) {
+	signal->loadstate(file);
+
+	BufferedSignalSource::loadstate(file);
+}
+
+void ResampledSignalSource::addcounters(EventCounters &counters) {
+	signal->getcounters(counters);
+
+	BufferedSignalSource::addcounters(counters);
+}
+
+void ResampledSignalSource::resetcounters() {
+	signal->resetcounters();
+
+	BufferedSignalSource::resetcounters();
+}
+
 
 // --- FileSignalSource ---
 
@@ -266,6 +420,31 @@ void FileSignalSource::reset(unsigned long seed ) {
     loadbuffer();
 }
 
+// the data file itself is not saved, only the read position; the
+// current block starts at sample initpos of the file
+
+void FileSignalSource::savestate(FILE *state) {
+    savebytes(state,&initpos,sizeof(long));
+    
+    BufferedSignalSource::savestate(state);
+}
+
+void FileSignalSource::loadstate(FILE *state) {
+    loadbytes(state,&initpos,sizeof(long));
+
+    if(fseek(file,initpos*sizeof(double),SEEK_SET) != 0) {
+        std::cerr << "FileSignalSource::loadstate(FILE *): cannot seek data file ["
+                  << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+        ExceptionFileError e;
+        throw e;
+    }
+    
+    loadbuffer();
+
+    BufferedSignalSource::loadstate(state);
+}
+
 
 // --- SampledSignalSource ---
 
@@ -403,7 +582,35 @@ void SignalFilter::reset(unsigned long seed) {
 	BufferedSignalSource::reset(seed);
 }
 
+// the filter history is the output buffer itself
+
+void SignalFilter::savestate(FILE *file) {
+	source->savestate(file);
+	
+	BufferedSignalSource::savestate(file);
+}
+
+void SignalFilter::loadstate(FILE *file) {
+	source->loadstate(file);
+	
+	BufferedSignalSource::loadstate(file);
+}
+
+void SignalFilter::addcounters(EventCounters &counters) {
+	source->getcounters(counters);
+	
+	BufferedSignalSource::addcounters(counters);
+}
+
+void SignalFilter::resetcounters() {
+	source->resetcounters();
+	
+	BufferedSignalSource::resetcounters();
+}
+
 double SignalFilter::getvalue(long pos) {
+	PROFILESTAGE(profilefilter);
+
 	return filter->getvalue(*source,*this,pos);
 }
 
@@ -653,6 +860,40 @@ Interpolator *getDerivativeInterpolator(int interplen) {
 }
 
 
+// SumSignal
+
+void SumSignal::values(const double *time,double *out,long n) {
+	double *temp = new double[n];
+
+	try {
+		signal1->values(time,out,n);
+		signal2->values(time,temp,n);
+	} catch (ExceptionOutOfBounds &e) {
+		delete [] temp;
+		throw e;
+	}
+
+	for(long i=0;i<n;i++) out[i] += temp[i];
+
+	delete [] temp;
+}
+
+void SumSignal::values(const double *timebase,const double *timecorr,double *out,long n) {
+	double *temp = new double[n];
+
+	try {
+		signal1->values(timebase,timecorr,out,n);
+		signal2->values(timebase,timecorr,temp,n);
+	} catch (ExceptionOutOfBounds &e) {
+		delete [] temp;
+		throw e;
+	}
+
+	for(long i=0;i<n;i++) out[i] += temp[i];
+
+	delete [] temp;
+}
+
 // InterpolatedSignal
 
 InterpolatedSignal::InterpolatedSignal(SignalSource *src,Interpolator *inte,
@@ -674,6 +915,8 @@ double InterpolatedSignal::value(double time) {
 		iint  = floor(ireal);
 		ifrac = ireal - iint;
 
+		PROFILESTAGE(profileinterpolator);
+
 		return normalize * interp->getvalue(*source,long(iint),ifrac);
 	} catch (ExceptionOutOfBounds &e) {
 		std::cerr << "InterpolateSignal::value(double) : OutOfBounds while accessing "
@@ -708,6 +951,8 @@ double InterpolatedSignal::value(double timebase,double timecorr) {
 
 		ifrac = ifracb + ifracc;
 
+		PROFILESTAGE(profileinterpolator);
+
 		if (ifrac >= 1.0) {
 			return normalize * interp->getvalue(*source,long(iintb+iintc)+1,ifrac-1.0);
 		} else {
@@ -722,6 +967,69 @@ double InterpolatedSignal::value(double timebase,double timecorr) {
 	}
 }
 
+// block versions of the above; the try block and the normalization
+// check are taken out of the loop
+
+void InterpolatedSignal::values(const double *time,double *out,long n) {
+	if (normalize == 0.0) {
+		for(long i=0;i<n;i++) out[i] = 0.0;
+		return;
+	}
+
+	long i = 0;
+
+	try {
+		for(;i<n;i++) {
+			double ireal = (time[i] + prebuffertime) / samplingtime;
+			double iint  = floor(ireal);
+
+			PROFILESTAGE(profileinterpolator);
+
+			out[i] = normalize * interp->getvalue(*source,long(iint),ireal - iint);
+		}
+	} catch (ExceptionOutOfBounds &e) {
+		std::cerr << "InterpolateSignal::values(double *,...) : OutOfBounds while accessing "
+		          << time[i] << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+		throw e;
+	}
+}
+
+void InterpolatedSignal::values(const double *timebase,const double *timecorr,double *out,long n) {
+	if (normalize == 0.0) {
+		for(long i=0;i<n;i++) out[i] = 0.0;
+		return;
+	}
+
+	long i = 0;
+
+	try {
+		for(;i<n;i++) {
+			double irealb = timebase[i] / samplingtime;
+			double iintb  = floor(irealb);
+
+			double irealc = (timecorr[i] + prebuffertime) / samplingtime;
+			double iintc  = floor(irealc);
+
+			double ifrac = (irealb - iintb) + (irealc - iintc);
+
+			PROFILESTAGE(profileinterpolator);
+
+			if (ifrac >= 1.0) {
+				out[i] = normalize * interp->getvalue(*source,long(iintb+iintc)+1,ifrac-1.0);
+			} else {
+				out[i] = normalize * interp->getvalue(*source,long(iintb+iintc),ifrac);
+			}
+		}
+	} catch (ExceptionOutOfBounds &e) {
+		std::cerr << "InterpolateSignal::values(double *,double *,...): OutOfBounds while accessing "
+		          << "(" << timebase[i] << "," << timecorr[i] << ")"
+				  << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+		throw e;
+	}
+}
+
 void InterpolatedSignal::setinterp(Interpolator *inte) {
 	interp = inte;
 }
@@ -783,6 +1091,266 @@ void PowerLawNoise::reset(unsigned long seed) {
 }
 
 
+
+// --- NoiseBank ---
+
+enum { banknofilter, bankdifffilter, bankintfilter };
+
+NoiseBank::NoiseBank(int count,double deltat,const double *prebuf,const double *psd,
+					 const double *exponent,const unsigned long *seed)
+	: channels(count), samplingtime(deltat), current(-1), generated(0), reread(0), nearstale(0) {
+
+	if (count < 1 || deltat <= 0.0) {
+		std::cerr << "NoiseBank::NoiseBank(...): need at least one channel and a positive sampling time"
+		          << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+		ExceptionWrongArguments e;
+		throw e;
+	}
+
+	for(int k=0;k<count;k++) {
+		if (exponent[k] != 0.00 && exponent[k] != 2.00 && exponent[k] != -2.00) {
+			std::cerr << "NoiseBank::NoiseBank(...): undefined PowerLaw exponent "
+			          << exponent[k] << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+			ExceptionUndefined e;
+			throw e;
+		}
+	}
+
+	// each ring is as long as the longest PowerLawNoise buffer, plus the
+	// lead that lockstep generation gives to the shorter-prebuffer channels
+
+	double maxpb = prebuf[0], minpb = prebuf[0];
+
+	for(int k=1;k<count;k++) {
+		if(prebuf[k] > maxpb) maxpb = prebuf[k];
+		if(prebuf[k] < minpb) minpb = prebuf[k];
+	}
+
+	length = long(maxpb/deltat+32) + long((maxpb-minpb)/deltat+1);
+
+	randgen = new gsl_rng*[count];
+	seededgen = new gsl_rng*[count];
+
+	cacheset = new int[count];
+	cacherand = new double[count];
+
+	filter = new int[count];
+	lastwhite = new double[count];
+	lastfiltered = new double[count];
+
+	prebuffer = new double[count];
+	normalize = new double[count];
+
+	data = new double[count * length];
+
+	double nyquistf = 0.5 / deltat;
+
+	for(int k=0;k<count;k++) {
+		if (exponent[k] == 0.00) {
+			filter[k] = banknofilter;
+			normalize[k] = sqrt(psd[k]) * sqrt(nyquistf);
+		} else if (exponent[k] == 2.00) {
+			filter[k] = bankdifffilter;
+			normalize[k] = sqrt(psd[k]) * sqrt(nyquistf) / (2.00 * M_PI * deltat);
+		} else {
+			filter[k] = bankintfilter;
+			normalize[k] = sqrt(psd[k]) * sqrt(nyquistf) * (2.00 * M_PI * deltat);
+		}
+
+		prebuffer[k] = prebuf[k];
+
+		randgen[k] = gsl_rng_alloc(gsl_rng_taus2);
+		seededgen[k] = gsl_rng_alloc(gsl_rng_taus2);
+
+		seedchannel(k,seed ? seed[k] : 0);
+	}
+
+	rewind();
+}
+
+NoiseBank::~NoiseBank() {
+	for(int k=0;k<channels;k++) {
+		gsl_rng_free(seededgen[k]);
+		gsl_rng_free(randgen[k]);
+	}
+
+	delete [] data;
+
+	delete [] normalize;
+	delete [] prebuffer;
+
+	delete [] lastfiltered;
+	delete [] lastwhite;
+	delete [] filter;
+
+	delete [] cacherand;
+	delete [] cacheset;
+
+	delete [] seededgen;
+	delete [] randgen;
+}
+
+Noise *NoiseBank::channel(int k) {
+	if (k < 0 || k >= channels) {
+		std::cerr << "NoiseBank::channel(" << k << "): no such channel"
+		          << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+		ExceptionOutOfBounds e;
+		throw e;
+	}
+
+	return new NoiseBankChannel(this,k);
+}
+
+// the generator state after seeding is kept, to restart the channel
+
+void NoiseBank::seedchannel(int k,unsigned long seed) {
+	gsl_rng_set(seededgen[k],seed == 0 ? WhiteNoiseSource::nextseed() : seed);
+}
+
+// restart all channels from their first sample
+
+void NoiseBank::rewind() {
+	for(int k=0;k<channels;k++) {
+		gsl_rng_memcpy(randgen[k],seededgen[k]);
+
+		cacheset[k] = 0;
+		cacherand[k] = 0;
+
+		lastwhite[k] = lastfiltered[k] = 0.0;
+	}
+
+	for(long i=0;i<channels*length;i++)
+		data[i] = 0.0;
+
+	current = -1;
+}
+
+// the other channels regenerate the same samples after the rewind, so
+// only channel k changes, as if it were a separate PowerLawNoise
+
+void NoiseBank::reset(int k,unsigned long seed) {
+	seedchannel(k,seed);
+
+	rewind();
+}
+
+/* The same deviates as WhiteNoiseSource::getvalue, and the same filters
+   as NoFilter, DiffFilter, and IntFilter(), for all channels at once;
+   the filter histories are kept by channel, rather than read back from
+   the buffers. */
+
+void NoiseBank::advance(long pos) {
+	PROFILESAMPLES(profilenoisebank,(pos - current) * channels);
+
+	for(long i=current+1;i<=pos;i++) {
+		double *store = data + (i % length);
+
+		for(int k=0;k<channels;k++,store+=length) {
+			double white;
+
+			if (cacheset[k] == 0) {
+				double x, y, r2;
+
+				do {
+					x = -1.0 + 2.0 * gsl_rng_uniform(randgen[k]);
+					y = -1.0 + 2.0 * gsl_rng_uniform(randgen[k]);
+
+					r2 = x * x + y * y;
+				} while (r2 > 1.0 || r2 == 0);
+
+				double root = sqrt (-2.0 * log (r2) / r2);
+
+				cacheset[k] = 1;
+				cacherand[k] = x * root;
+
+				white = y * root;
+			} else {
+				cacheset[k] = 0;
+				white = cacherand[k];
+			}
+
+			double filtered;
+
+			if (filter[k] == banknofilter)
+				filtered = white;
+			else if (filter[k] == bankdifffilter)
+				filtered = white - lastwhite[k];
+			else
+				filtered = 0.9999 * lastfiltered[k] + white;
+
+			lastwhite[k] = white;
+			lastfiltered[k] = filtered;
+
+			*store = filtered;
+		}
+	}
+
+	generated += (pos - current) * channels;
+	current = pos;
+}
+
+void NoiseBank::stale(int k,long pos) {
+	std::cerr << "NoiseBank::value(...): stale sample access at "
+	          << pos << " in channel " << k << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+	ExceptionOutOfBounds e;
+	throw e;
+}
+
+// the raw generator state is portable only between identical builds;
+// the shared position is saved with every channel
+
+void NoiseBank::savestate(int k,FILE *file) {
+	long size = gsl_rng_size(randgen[k]);
+
+	savebytes(file,&size,sizeof(long));
+	savebytes(file,gsl_rng_state(randgen[k]),size);
+	savebytes(file,gsl_rng_state(seededgen[k]),size);
+
+	savebytes(file,&cacheset[k],sizeof(int));
+	savebytes(file,&cacherand[k],sizeof(double));
+
+	savebytes(file,&lastwhite[k],sizeof(double));
+	savebytes(file,&lastfiltered[k],sizeof(double));
+
+	savebytes(file,&current,sizeof(long));
+
+	savebytes(file,&length,sizeof(long));
+	savebytes(file,data + k * length,length*sizeof(double));
+}
+
+void NoiseBank::loadstate(int k,FILE *file) {
+	loadcheck(file,gsl_rng_size(randgen[k]),"generator state size");
+	loadbytes(file,gsl_rng_state(randgen[k]),gsl_rng_size(randgen[k]));
+	loadbytes(file,gsl_rng_state(seededgen[k]),gsl_rng_size(seededgen[k]));
+
+	loadbytes(file,&cacheset[k],sizeof(int));
+	loadbytes(file,&cacherand[k],sizeof(double));
+
+	loadbytes(file,&lastwhite[k],sizeof(double));
+	loadbytes(file,&lastfiltered[k],sizeof(double));
+
+	loadbytes(file,&current,sizeof(long));
+
+	loadcheck(file,length,"buffer length");
+	loadbytes(file,data + k * length,length*sizeof(double));
+}
+
+void NoiseBank::getcounters(EventCounters &counters) {
+	if(!counters.visit(this)) return;
+
+	counters.add("samples-generated",generated);
+	counters.add("samples-reread",reread);
+	counters.add("stale-near-misses",nearstale);
+}
+
+void NoiseBank::resetcounters() {
+	generated = reread = nearstale = 0;
+}
+
 // SampledSignal
 
 SampledSignal::SampledSignal(double *narray,long length,double deltat,double prebuffer,
@@ -11,6 +11,41 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
+
+#include <vector>
+
+/* Event counters for cache and buffer behavior. getcounters(counters)
+   adds the counts kept by an object (and by the objects it uses, by
+   calling their getcounters) to counters, summing the counts with the
+   same name; an object that is reached twice (e.g., a noise shared by
+   two TDI objects) is counted once. resetcounters() zeroes the counts
+   of an object and of the objects it uses. */
+
+class EventCounters {
+ private:
+    std::vector<const void *> visited;
+
+ public:
+    std::vector<const char *> names;
+    std::vector<long> values;
+
+    // returns 0 if obj has already been counted
+
+    int visit(const void *obj);
+
+    void add(const char *name,long value);
+};
+
+/* Checkpointing: objects that carry state (random generators, ring
+   buffers, filter histories, caches) write it to an open binary file with
+   savestate(), and read it back with loadstate() into an object graph
+   built identically; these helpers throw ExceptionFileError on I/O errors
+   or on a mismatch between the saved and the current objects. */
+
+extern void savebytes(FILE *file,const void *data,size_t size);
+extern void loadbytes(FILE *file,void *data,size_t size);
+extern void loadcheck(FILE *file,long value,const char *what);
 
 class RingBuffer {
  private:
@@ -22,6 +57,9 @@ class RingBuffer {
 	~RingBuffer();
 	
 	void reset();
+
+	void savestate(FILE *file);
+	void loadstate(FILE *file);
 	
 	inline double& operator[](long pos);
 };
@@ -43,6 +81,20 @@ class SignalSource {
 
 	virtual void reset(unsigned long seed = 0) {};
 	virtual double operator[](long pos) = 0;
+
+	// stateless sources need not redefine these
+
+	virtual void savestate(FILE *file) {};
+	virtual void loadstate(FILE *file) {};
+
+	// counters; classes that keep them redefine addcounters
+
+	void getcounters(EventCounters &counters) {
+		if(counters.visit(this)) addcounters(counters);
+	};
+
+	virtual void addcounters(EventCounters &counters) {};
+	virtual void resetcounters() {};
 };
 
 
@@ -56,6 +108,11 @@ class BufferedSignalSource : public SignalSource {
 
 	long current;
 
+	// samples computed by getvalue, buffered samples read again, and
+	// reads within the oldest eighth of the buffer (close to going stale)
+
+	long generated, reread, nearstale;
+
  public:
 	BufferedSignalSource(long len);
 	virtual ~BufferedSignalSource() {}; // ??? would "= 0" do here?
@@ -64,6 +121,12 @@ class BufferedSignalSource : public SignalSource {
 
 	virtual void reset(unsigned long seed = 0); // ??? redefining default
 	virtual double operator[](long pos);
+
+	virtual void savestate(FILE *file);
+	virtual void loadstate(FILE *file);
+
+	virtual void addcounters(EventCounters &counters);
+	virtual void resetcounters();
 };
 
 
@@ -94,8 +157,15 @@ class WhiteNoiseSource : public BufferedSignalSource {
 		
 	void reset(unsigned long seed = 0);  // ??? redefining default
 
+	void savestate(FILE *file);
+	void loadstate(FILE *file);
+
     static void setglobalseed(unsigned long seed = 0);
     static unsigned long getglobalseed();
+
+    // returns the global seed and moves it on, for seed = 0
+
+    static unsigned long nextseed();
 };
 
 
@@ -132,6 +202,9 @@ class FileSignalSource : public BufferedSignalSource {
 	double getvalue(long pos);
 	
 	void reset(unsigned long seed = 0);  // ??? redefining default
+
+	void savestate(FILE *file);
+	void loadstate(FILE *file);
 };
 
 
@@ -218,6 +291,12 @@ class SignalFilter : public BufferedSignalSource {
 	double getvalue(long pos);
 	
 	void reset(unsigned long seed = 0);  // ??? redefining default
+
+	void savestate(FILE *file);
+	void loadstate(FILE *file);
+
+	void addcounters(EventCounters &counters);
+	void resetcounters();
 };
 
 
@@ -237,6 +316,32 @@ class Signal {
 		return value(timebase + timecorr);
 	};
 
+	// batch evaluation at the n times time[i] (or timebase[i] + timecorr[i]),
+	// which should be nondecreasing; derived classes can override these to
+	// avoid one virtual call per sample
+
+	virtual void values(const double *time,double *out,long n) {
+		for(long i=0;i<n;i++) out[i] = value(time[i]);
+	};
+
+	virtual void values(const double *timebase,const double *timecorr,double *out,long n) {
+		for(long i=0;i<n;i++) out[i] = value(timebase[i],timecorr[i]);
+	};
+
+	// checkpointing (see above); stateless signals need not redefine these
+
+	virtual void savestate(FILE *file) {};
+	virtual void loadstate(FILE *file) {};
+
+	// counters (see above)
+
+	void getcounters(EventCounters &counters) {
+		if(counters.visit(this)) addcounters(counters);
+	};
+
+	virtual void addcounters(EventCounters &counters) {};
+	virtual void resetcounters() {};
+
 	// for backward compatibility
 
 	virtual double operator[](double time) { return value(time); };
@@ -369,6 +474,32 @@ class SumSignal : public Signal {
         return signal1->value(timebase,timecorr) +
                signal2->value(timebase,timecorr);
     };
+
+    // these evaluate signal1 over the whole block before signal2,
+    // so the two should not share buffered sources
+
+    void values(const double *time,double *out,long n);
+    void values(const double *timebase,const double *timecorr,double *out,long n);
+
+    void savestate(FILE *file) {
+        signal1->savestate(file);
+        signal2->savestate(file);
+    };
+
+    void loadstate(FILE *file) {
+        signal1->loadstate(file);
+        signal2->loadstate(file);
+    };
+
+    void addcounters(EventCounters &counters) {
+        signal1->getcounters(counters);
+        signal2->getcounters(counters);
+    };
+
+    void resetcounters() {
+        signal1->resetcounters();
+        signal2->resetcounters();
+    };
 };
 
 
@@ -388,6 +519,15 @@ class InterpolatedSignal : public Signal {
 
 	double value(double time);
 	double value(double timebase,double timecorr);
+
+	void values(const double *time,double *out,long n);
+	void values(const double *timebase,const double *timecorr,double *out,long n);
+
+	void savestate(FILE *file) { source->savestate(file); };
+	void loadstate(FILE *file) { source->loadstate(file); };
+
+	void addcounters(EventCounters &counters) { source->getcounters(counters); };
+	void resetcounters() { source->resetcounters(); };
 	
 	void setinterp(Interpolator *inte);
 };
@@ -419,8 +559,17 @@ class PowerLawNoise : public Signal {
 
 	void reset(unsigned long seed = 0);  // ??? redefining default
 
+	void savestate(FILE *file) { interpolatednoise->savestate(file); };
+	void loadstate(FILE *file) { interpolatednoise->loadstate(file); };
+
+	void addcounters(EventCounters &counters) { interpolatednoise->getcounters(counters); };
+	void resetcounters() { interpolatednoise->resetcounters(); };
+
 	double value(double time);
 	double value(double timebase,double timecorr);
+
+	void values(const double *time,double *out,long n);
+	void values(const double *timebase,const double *timecorr,double *out,long n);
 };
 
 inline double PowerLawNoise::value(double time) {
@@ -431,6 +580,162 @@ inline double PowerLawNoise::value(double timebase,double timecorr) {
 	return interpolatednoise->value(timebase,timecorr);
 }
 
+inline void PowerLawNoise::values(const double *time,double *out,long n) {
+	interpolatednoise->values(time,out,n);
+}
+
+inline void PowerLawNoise::values(const double *timebase,const double *timecorr,double *out,long n) {
+	interpolatednoise->values(timebase,timecorr,out,n);
+}
+
+
+// --- NoiseBank ---
+
+/* NoiseBank generates together a set of power-law noises that share a
+   sampling time (such as the 18 noises of TDInoise): a single loop draws
+   the Gaussian deviates, applies the filters, and stores the samples of
+   all channels, in lockstep, into one block that holds a ring buffer per
+   channel (channel k at data[k*length ...]). Channel k reproduces exactly
+   PowerLawNoise(deltat,prebuffer[k],psd[k],exponent[k],1,seed[k]); the
+   channels are seeded in order (from the global seed if seed is null or
+   seed[k] is 0), and read with linear interpolation through the Noise
+   objects returned by channel(k), which must be deleted before the bank.
+   Resetting channel k reseeds it and restarts it from its first sample,
+   as for a PowerLawNoise; since the channels share their position, the
+   others are rewound too, but to the generator state of their own last
+   seeding, so they regenerate exactly the same samples. */
+
+class NoiseBank {
+ private:
+	int channels;
+	double samplingtime;
+
+	long length, current;
+
+	// generators, filters, and normalizations, by channel
+
+	gsl_rng **randgen, **seededgen;
+
+	int *cacheset;
+	double *cacherand;
+
+	int *filter;
+	double *lastwhite, *lastfiltered;
+
+	double *prebuffer, *normalize;
+
+	double *data;
+
+	long generated, reread, nearstale;
+
+	void seedchannel(int k,unsigned long seed);
+	void rewind();
+
+	void advance(long pos);
+	void stale(int k,long pos);
+
+	double interpolate(int k,long ind,double dind);
+
+ public:
+	NoiseBank(int count,double deltat,const double *prebuffer,const double *psd,
+			  const double *exponent,const unsigned long *seed = 0);
+	~NoiseBank();
+
+	int size() { return channels; };
+
+	Noise *channel(int k);
+
+	double value(int k,double time);
+	double value(int k,double timebase,double timecorr);
+
+	void reset(int k,unsigned long seed = 0);
+
+	void savestate(int k,FILE *file);
+	void loadstate(int k,FILE *file);
+
+	void getcounters(EventCounters &counters);
+	void resetcounters();
+};
+
+// same arithmetic as LinearInterpolator within InterpolatedSignal
+
+inline double NoiseBank::interpolate(int k,long ind,double dind) {
+	if (ind + 1 > current) {
+		advance(ind + 1);
+	} else if (ind <= current - length) {
+		stale(k,ind);
+	} else {
+		reread++;
+		if(ind <= current - length + length/8) nearstale++;
+	}
+
+	const double *ring = data + k * length;
+
+	long slot = ind % length;
+	if(slot < 0) slot += length;
+	long next = (slot + 1 == length ? 0 : slot + 1);
+
+	return (1.0 - dind) * ring[slot] + dind * ring[next];
+}
+
+inline double NoiseBank::value(int k,double time) {
+	if (normalize[k] == 0.0) return 0.0;
+
+	double ireal = (time + prebuffer[k]) / samplingtime;
+	double iint  = floor(ireal);
+
+	return normalize[k] * interpolate(k,long(iint),ireal - iint);
+}
+
+inline double NoiseBank::value(int k,double timebase,double timecorr) {
+	if (normalize[k] == 0.0) return 0.0;
+
+	double irealb = timebase / samplingtime;
+	double iintb  = floor(irealb);
+
+	double irealc = (timecorr + prebuffer[k]) / samplingtime;
+	double iintc  = floor(irealc);
+
+	double ifrac = (irealb - iintb) + (irealc - iintc);
+
+	if (ifrac >= 1.0) {
+		return normalize[k] * interpolate(k,long(iintb+iintc)+1,ifrac-1.0);
+	} else {
+		return normalize[k] * interpolate(k,long(iintb+iintc),ifrac);
+	}
+}
+
+// the Noise view of one NoiseBank channel
+
+class NoiseBankChannel : public Signal {
+ private:
+	NoiseBank *bank;
+	int k;
+
+ public:
+	NoiseBankChannel(NoiseBank *nb,int channel)
+		: bank(nb), k(channel) {};
+
+	void reset(unsigned long seed = 0) { bank->reset(k,seed); };
+
+	void savestate(FILE *file) { bank->savestate(k,file); };
+	void loadstate(FILE *file) { bank->loadstate(k,file); };
+
+	void addcounters(EventCounters &counters) { bank->getcounters(counters); };
+	void resetcounters() { bank->resetcounters(); };
+
+	double value(double time) { return bank->value(k,time); };
+	double value(double timebase,double timecorr) { return bank->value(k,timebase,timecorr); };
+
+	void values(const double *time,double *out,long n) {
+		for(long i=0;i<n;i++) out[i] = bank->value(k,time[i]);
+	};
+
+	void values(const double *timebase,const double *timecorr,double *out,long n) {
+		for(long i=0;i<n;i++) out[i] = bank->value(k,timebase[i],timecorr[i]);
+	};
+};
+
 
 // --- SampledSignal ---
 
@@ -450,8 +755,17 @@ class SampledSignal : public Signal {
 
     // nothing to reset...
 
+	void savestate(FILE *file) { interpolatednoise->savestate(file); };
+	void loadstate(FILE *file) { interpolatednoise->loadstate(file); };
+
+	void addcounters(EventCounters &counters) { interpolatednoise->getcounters(counters); };
+	void resetcounters() { interpolatednoise->resetcounters(); };
+
 	double value(double time);
 	double value(double timebase,double timecorr);
+
+	void values(const double *time,double *out,long n);
+	void values(const double *timebase,const double *timecorr,double *out,long n);
 };
 
 inline double SampledSignal::value(double time) {
@@ -462,6 +776,14 @@ inline double SampledSignal::value(double timebase,double timecorr) {
 	return interpolatednoise->value(timebase,timecorr);
 }
 
+inline void SampledSignal::values(const double *time,double *out,long n) {
+	interpolatednoise->values(time,out,n);
+}
+
+inline void SampledSignal::values(const double *timebase,const double *timecorr,double *out,long n) {
+	interpolatednoise->values(timebase,timecorr,out,n);
+}
+
 
 // --- CachedSignal (uses ResampledSignalSource) ---
 
@@ -478,6 +800,12 @@ class ResampledSignalSource : public BufferedSignalSource {
 	void reset(unsigned long seed = 0);  // ??? redefining default
 
 	double getvalue(long pos);
+
+	void savestate(FILE *file);
+	void loadstate(FILE *file);
+
+	void addcounters(EventCounters &counters);
+	void resetcounters();
 };
 
 class CachedSignal : public Signal {
@@ -492,8 +820,17 @@ class CachedSignal : public Signal {
 
     void reset(unsigned long seed = 0);  // ??? redefining default
 
+	void savestate(FILE *file) { interpsignal->savestate(file); };
+	void loadstate(FILE *file) { interpsignal->loadstate(file); };
+
+	void addcounters(EventCounters &counters) { interpsignal->getcounters(counters); };
+	void resetcounters() { interpsignal->resetcounters(); };
+
 	double value(double time);
 	double value(double timebase,double timecorr);
+
+	void values(const double *time,double *out,long n);
+	void values(const double *timebase,const double *timecorr,double *out,long n);
 };
 
 inline double CachedSignal::value(double time) {
@@ -504,6 +841,14 @@ inline double CachedSignal::value(double timebase,double timecorr) {
 	return interpsignal->value(timebase,timecorr);
 }
 
+inline void CachedSignal::values(const double *time,double *out,long n) {
+	interpsignal->values(time,out,n);
+}
+
+inline void CachedSignal::values(const double *timebase,const double *timecorr,double *out,long n) {
+	interpsignal->values(timebase,timecorr,out,n);
+}
+
 #endif /* _LISASIM_SIGNAL_H_ */
 
 
@@ -12,6 +12,7 @@
 %module lisaswig
 %{
 #include "lisasim.h"
+#include "lisasim-python.h"
 %}
 
 %include lisasim-typemaps.i
@@ -42,6 +43,53 @@ Destructor. See above.
 };
 %enddef
 
+// the fastgetobs family runs without the GIL, so that other Python threads
+// can proceed; the C++ code retakes it to check for Ctrl-C and to call
+// back into PyLISA, AllPyLISA, and PyWave objects
+
+%define threadedexceptionhandle(thefunction)
+%exception thefunction {
+    PyThreadState *_save = PyEval_SaveThread();
+
+    try {
+        $action
+    } catch (ExceptionKeyboardInterrupt &e) {
+        PyEval_RestoreThread(_save);
+        if(!PyErr_Occurred()) PyErr_SetString(PyExc_KeyboardInterrupt,"");
+        return NULL;
+    } catch (ExceptionCancelled &e) {
+        PyEval_RestoreThread(_save);
+        PyErr_SetString(PyExc_RuntimeError,"cancelled");
+        return NULL;
+    } catch (ExceptionOutOfBounds &e) {
+        PyEval_RestoreThread(_save);
+        PyErr_SetString(PyExc_IndexError,"");
+        return NULL;
+    } catch (ExceptionWrongArguments &e) {
+        PyEval_RestoreThread(_save);
+        PyErr_SetString(PyExc_ValueError,"");
+        return NULL;
+    } catch (ExceptionUndefined &e) {
+        PyEval_RestoreThread(_save);
+        PyErr_SetString(PyExc_ValueError,"");
+        return NULL;
+    } catch (ExceptionFileError &e) {
+        PyEval_RestoreThread(_save);
+        PyErr_SetString(PyExc_IOError,"");
+        return NULL;
+    }
+
+    PyEval_RestoreThread(_save);
+};
+%enddef
+
+%init %{
+    PyEval_InitThreads();
+
+    // let the fastgetobs functions see Ctrl-C
+    setinterrupthook(pythoninterrupt);
+%}
+
 %pythoncode %{
 import numpy
 
@@ -59,6 +107,8 @@ globalseed = 0
 cseeds = []
 
 def setglobalseed(seed = 0):
+    global globalseed
+
     globalseed = seed
     random.seed(globalseed)
 
@@ -113,6 +163,36 @@ given in units of the speed of light."
 LISA.reset() resets any underlying pseudo-random or ring-buffer
 elements used by the LISA object."
 
+%feature("docstring") LISA::counters "
+counters() returns a dictionary with the event counters of this LISA
+object and of the LISA objects that it uses: 'armlength-iterations'
+(bisection steps in the generic armlength), 'settime-recomputations'
+(EccentricInclined spacecraft positions), 'retard-hits',
+'retard-misses', 'retard-collisions' (computed retardations that
+overwrite a different retardation cached for the same time; if
+frequent, increase buflength), 'putp-hits', 'putp-misses' (CacheLISA),
+and the buffer counters of SignalSource.counters for CacheLengthLISA
+and SampledLISA. Shared objects are counted once."
+
+%feature("docstring") LISA::delaysymmetry "
+LISA.delaysymmetry() returns the symmetries of the delays of this LISA
+object, as a combination (or) of delaystatic (the armlengths do not
+depend on time, so delays commute), delaysymmetric (nor on the
+direction of propagation), and delayequal (nor on the arm); for
+instance, OriginalLISA with equal arms returns all three. Of the
+rotating geometries, ModifiedLISA (rigid rotation, with constant Sagnac
+delays) is static; CircularRotating, EccentricInclined, and the other
+orbiting LISAs have time-varying armlengths, and return 0. See
+TDI.simplified."
+
+%constant int delaystatic = delaystatic;
+%constant int delaysymmetric = delaysymmetric;
+%constant int delayequal = delayequal;
+
+%feature("docstring") LISA::resetcounters "
+resetcounters() zeroes the event counters of this LISA object and of
+the LISA objects that it uses."
+
 %nodefault LISA;
 
 class LISA {
@@ -125,6 +205,19 @@ class LISA {
     virtual double dotarmlength(int arm, double t);
 
     virtual void reset();
+
+    virtual int delaysymmetry();
+
+    virtual void resetcounters();
+
+    %extend {
+        PyObject *counters() {
+            EventCounters counters;
+            self->getcounters(counters);
+
+            return counterdict(counters);
+        };
+    };
 };
 
 
@@ -375,11 +468,30 @@ extern double retardation(LISA *lisa,int ret1,int ret2,int ret3,int ret4,int ret
 
 exceptionhandle(SignalSource::__getitem__,ExceptionOutOfBounds,PyExc_IndexError)
 
+%feature("docstring") SignalSource::counters "
+counters() returns a dictionary with the event counters of the
+buffered sources in this object: 'samples-generated' (samples
+computed), 'samples-reread' (buffered samples read again), and
+'stale-near-misses' (reads within the oldest eighth of a buffer, which
+suggest that the buffer or prebuffer is barely long enough). Shared
+objects are counted once; resetcounters() zeroes the counters."
+
 %nodefault SignalSource;
 class SignalSource {
  public:
     virtual void reset(unsigned long seed = 0);
 
+    virtual void resetcounters();
+
+    %extend {
+        PyObject *counters() {
+            EventCounters counters;
+            self->getcounters(counters);
+
+            return counterdict(counters);
+        };
+    };
+
     %extend {
         double __getitem__(long pos) {
             return (*self)[pos];
@@ -469,6 +581,12 @@ class SignalFilter : public SignalSource {
 exceptionhandle(Signal::value,ExceptionOutOfBounds,PyExc_IndexError)
 exceptionhandle(Signal::__call__,ExceptionOutOfBounds,PyExc_IndexError)
 
+%feature("docstring") Signal::counters "
+counters() returns a dictionary with the event counters of the
+buffered sources (see SignalSource.counters) and LISA objects (see
+LISA.counters) used by this Signal or Noise object; resetcounters()
+zeroes them."
+
 %nodefault Signal;
 class Signal {
  public:
@@ -477,6 +595,17 @@ class Signal {
     virtual double value(double time);
     virtual double value(double timebase,double timecorr);
 
+    virtual void resetcounters();
+
+    %extend {
+        PyObject *counters() {
+            EventCounters counters;
+            self->getcounters(counters);
+
+            return counterdict(counters);
+        };
+    };
+
     %extend {
         double __call__(double time) {
             return self->value(time);
@@ -1079,6 +1208,16 @@ exceptionhandle(TDI::X1,ExceptionOutOfBounds,PyExc_IndexError)
 exceptionhandle(TDI::X2,ExceptionOutOfBounds,PyExc_IndexError)
 exceptionhandle(TDI::X3,ExceptionOutOfBounds,PyExc_IndexError)
 
+exceptionhandle(TDI::Am,ExceptionOutOfBounds,PyExc_IndexError)
+exceptionhandle(TDI::Em,ExceptionOutOfBounds,PyExc_IndexError)
+exceptionhandle(TDI::Tm,ExceptionOutOfBounds,PyExc_IndexError)
+
+exceptionhandle(TDI::A1,ExceptionOutOfBounds,PyExc_IndexError)
+exceptionhandle(TDI::E1,ExceptionOutOfBounds,PyExc_IndexError)
+exceptionhandle(TDI::T1,ExceptionOutOfBounds,PyExc_IndexError)
+
+exceptionhandle(TDI::combination,ExceptionUndefined,PyExc_ValueError)
+
 exceptionhandle(TDI::y,ExceptionOutOfBounds,PyExc_IndexError)
 exceptionhandle(TDI::z,ExceptionOutOfBounds,PyExc_IndexError)
 
@@ -1117,11 +1256,213 @@ class TDIobjectpnt  : public TDIobject {
 %nodefault timeobject;
 class timeobject : public Signal {};
 
-exceptionhandle(fastgetobsc,ExceptionKeyboardInterrupt,PyExc_KeyboardInterrupt)
+threadedexceptionhandle(fastgetobs)
+threadedexceptionhandle(fastgetobsc)
 
 extern void fastgetobs(double *numarray,long length,long samples,double stime,Signal **thesignals,int signals,double inittime);
 extern void fastgetobsc(double *numarray,long length,long samples,double stime,Signal **thesignals,int signals,double inittime);
 
+%feature("docstring") fastgetobschunk "
+fastgetobschunk(array,samples,stime,observables,inittime,offset)
+fills array with samples of the observables at times inittime +
+i*stime, for i = offset ... offset + samples - 1. Successive calls with
+increasing offsets continue from the state of the observables left by
+the previous call, without recomputing it. See lisautils.getobsiter."
+
+threadedexceptionhandle(fastgetobschunk)
+
+extern void fastgetobschunk(double *numarray,long length,long samples,double stime,Signal **thesignals,int signals,double inittime,long offset);
+
+%feature("docstring") fastgetobstimes "
+fastgetobstimes(array,times,observables)
+fills array with the observables evaluated at the times in the numpy
+array times, which must be sorted in increasing order (ValueError is
+raised otherwise), so that the buffered noises are still filled
+forward. The rows of array correspond to the elements of times. See
+lisautils.getobstimes."
+
+threadedexceptionhandle(fastgetobstimes)
+
+extern void fastgetobstimes(double *numarray,long length,double *numarray,long length,Signal **thesignals,int signals);
+
+%feature("docstring") fastgetobsdec "
+fastgetobsdec(array,samples,stime,observables,inittime,decimation,filter)
+fills array with samples of the observables decimated by the integer
+factor decimation: output sample k is
+sum_m filter[m] * obs(inittime + (k*decimation + m)*stime), where
+taps = len(filter), and is centered on time
+inittime + ((taps-1)/2 + k*decimation)*stime, so that no observable is
+evaluated before inittime. The full-rate series is never stored, and the
+filter is evaluated only at the output points. See lisautils.getobsdec
+and lisautils.lowpassfir."
+
+threadedexceptionhandle(fastgetobsdec)
+
+extern void fastgetobsdec(double *numarray,long length,long samples,double stime,Signal **thesignals,int signals,double inittime,int decimation,double *doublearray,int doublenum);
+
+%feature("docstring") fastgetobsf "
+fastgetobsf(array,samples,stime,observables,inittime,offset=0,display=0)
+same as fastgetobschunk (or fastgetobs/fastgetobsc, with offset = 0),
+but for a numpy array of single-precision floats (dtype 'f'): the
+observables are still computed in double precision, and converted only
+when stored."
+
+threadedexceptionhandle(fastgetobsf)
+
+extern void fastgetobsf(float *numarray,long length,long samples,double stime,Signal **thesignals,int signals,double inittime,long offset = 0,int display = 0);
+
+%feature("docstring") fastgetobsfd "
+fastgetobsfd(fd,samples,stime,observables,inittime,display=0,single=0,offset=0)
+evaluates the observables at times inittime + i*stime (offset <= i <
+offset + samples, continuing as in fastgetobschunk) and
+writes them to the open file descriptor fd (e.g., file.fileno()) in
+batches of 16384 rows, as native-endian doubles (or floats, if single is
+set) with simultaneous values on the same row (the layout of lisaXML
+Binary streams). The batches are written by a separate thread while
+the next ones are computed, so memory use (at most four batches in
+flight) does not grow with samples. If display is set, show progress as
+fastgetobsc does."
+
+%feature("docstring") fastgetobsfile "
+fastgetobsfile(filename,samples,stime,observables,inittime,display=0,append=0,single=0,offset=0)
+same as fastgetobsfd, but opens (and truncates, unless append is set)
+the file filename. See lisautils.getobsfile for a friendlier interface."
+
+threadedexceptionhandle(fastgetobsfd)
+threadedexceptionhandle(fastgetobsfile)
+
+extern void fastgetobsfd(int fd,long samples,double stime,Signal **thesignals,int signals,double inittime,int display = 0,int single = 0,long offset = 0);
+extern void fastgetobsfile(const char *filename,long samples,double stime,Signal **thesignals,int signals,double inittime,int display = 0,int append = 0,int single = 0,long offset = 0);
+
+%feature("docstring") savecheckpoint "
+savecheckpoint(filename,tdi,offset)
+writes to filename the complete state of the TDI object tdi (noise
+generators and buffers, filter histories, LISA caches), together with
+offset, the index of the next sample to compute. The file is replaced
+atomically, so an interrupted save leaves the previous checkpoint intact.
+Wave objects (for TDIsignal) are not saved. See
+lisautils.getobscheckpoint."
+
+%feature("docstring") loadcheckpoint "
+loadcheckpoint(filename,tdi)
+restores the state saved by savecheckpoint into tdi, which must have
+been built exactly as the original (same classes, noise seeds, and
+buffer lengths; IOError is raised if the state does not fit), and
+returns the offset of the next sample. The run can then be continued
+with fastgetobschunk or fastgetobsfile, giving the same output as an
+uninterrupted run."
+
+threadedexceptionhandle(savecheckpoint)
+threadedexceptionhandle(loadcheckpoint)
+
+extern void savecheckpoint(const char *filename,TDI *tdi,long offset);
+extern long loadcheckpoint(const char *filename,TDI *tdi);
+
+%feature("docstring") cancelobs "
+cancelobs() makes all the fastgetobs functions (fastgetobs, fastgetobsc,
+fastgetobschunk, fastgetobstimes, fastgetobsdec, fastgetobsf, fastgetobsfd,
+fastgetobsfile, fastgetobspar, fastgetensemble) currently running in any thread stop at
+their next batch of samples and raise RuntimeError. Calls started
+afterwards are not affected. Since these functions release the GIL
+while they run, cancelobs can be called from another Python thread."
+
+extern void cancelobs();
+
+%feature("docstring") fastgetobspar "
+fastgetobspar(array,samples,stime,observables,replicas,inittime,warmup=0,offset=0)
+fills array with samples of the observables at times
+inittime + (offset + i)*stime,
+dividing the time range into contiguous chunks that are computed in
+parallel threads. The observables sequence must hold replicas copies of
+the same list of observables, built from separate (but identical) LISA,
+Noise, and TDI objects; the observables of replica r occupy positions
+r*n ... r*n + n - 1. Each thread evaluates (and discards) warmup samples
+before the beginning of its chunk. Do not use with PyLISA, AllPyLISA,
+or PyWave objects. See lisautils.getobspar for a friendlier interface."
+
+threadedexceptionhandle(fastgetobspar)
+
+extern void fastgetobspar(double *numarray,long length,long samples,double stime,Signal **thesignals,int signals,int replicas,double inittime,long warmup = 0,long offset = 0);
+
+%feature("docstring") fastgetobssched "
+fastgetobssched(array,samples,stime,observables,replicas,groupsizes,costs,
+                threads,inittime,chunk=16384,warmup=0)
+fills array as fastgetobspar does, but for observables of very different
+cost. The observables of each replica are divided into consecutive
+groups (groupsizes lists the number of observables in each group), which
+must not share LISA, Noise, or TDI objects; the time range is divided
+into chunks of chunk samples. Each (group, chunk) pair is a task; the
+tasks of each group replica are run in order, and threads idle workers
+steal waiting group replicas from busy ones. The time (in seconds) spent
+on each task is written to costs[group*chunks + chunk], with chunks =
+ceil(samples/chunk). Do not use with PyLISA, AllPyLISA, or PyWave
+objects. See lisautils.getobssched for a friendlier interface."
+
+threadedexceptionhandle(fastgetobssched)
+
+extern void fastgetobssched(double *numarray,long length,long samples,double stime,
+                            Signal **thesignals,int signals,int replicas,int *theints,int ints,
+                            double *numarray,long length,int threads,double inittime,
+                            long chunk = 16384,long warmup = 0);
+
+%feature("docstring") fastgetensemble "
+fastgetensemble(array,samples,stime,lisas,observables,seeds,rates,noisepars,
+                interp=1,inittime=0.0)
+runs one TDInoise realization for each seed in seeds, with the standard
+noise parameters noisepars = [PMdt,PMpsd,SHdt,SHpsd,LSdt,LSpsd] (see
+TDInoise), on as many threads as there are LISA objects in lisas (each
+thread needs its own). The observables (a list of names such as 'X1')
+for realization r are written to array[r*samples*n ...], where n is
+the number of observables, and its throughput (samples/s) to rates[r].
+The 18 noises of the realization with seed s are seeded with
+ensembleseed(s,k), k = 0...17. See lisautils.getensemble for a
+friendlier interface."
+
+%feature("docstring") ensembleseed "
+ensembleseed(seed,stream) returns the pseudorandom seed used by
+fastgetensemble for noise stream (0...17) of the realization with the
+given seed: streams 0-5 are the proof-mass noises, 6-11 the optical-path
+noises, and 12-17 the laser noises, in the order expected by TDInoise.
+The result is 1 + 18*seed + stream, which is never zero and fits in 32
+bits; seeds larger than (2^32 - 19)/18 raise ValueError (also in
+fastgetensemble)."
+
+exceptionhandle(ensembleseed,ExceptionWrongArguments,PyExc_ValueError)
+
+threadedexceptionhandle(fastgetensemble)
+
+extern void fastgetensemble(double *numarray,long length,long samples,double stime,
+                            LISA **thelisas,int lisas,char **thenames,int names,
+                            unsigned long *theseeds,int seeds,double *numarray,long length,
+                            double *doublearray,int doublenum,int interp = 1,double inittime = 0.0);
+
+extern unsigned long ensembleseed(unsigned long seed,int stream);
+
+%feature("docstring") setprofile "
+setprofile(enable) turns the per-stage profiler on or off. The profiler
+is available only if synthLISA was built with python setup.py
+--with-profile (see profilecompiled()); otherwise the instrumentation
+is not compiled in, and costs nothing. Use resetprofile() to zero the
+counters, and lisautils.getprofile() to read them as a dictionary."
+
+%feature("docstring") profilename "
+profilename(stage), profilecalls(stage), profiletime(stage) return the
+name, number of calls, and inclusive wall time (in seconds) of profiled
+stage 0...profilestages-1; for NoiseBank::advance, which fills all its
+channels in batches, the count is of samples generated rather than of
+calls. See lisautils.getprofile."
+
+extern int profilecompiled();
+
+extern void setprofile(int enable);
+extern void resetprofile();
+
+extern const char *profilename(int stage);
+extern long profilecalls(int stage);
+extern double profiletime(int stage);
+
+%constant int profilestages = profilestages;
+
 %newobject TDI::alpham();
 %newobject TDI::betam();
 %newobject TDI::gammam();
@@ -1152,6 +1493,14 @@ extern void fastgetobsc(double *numarray,long length,long samples,double stime,S
 %newobject TDI::X2();
 %newobject TDI::X3();
 
+%newobject TDI::Am();
+%newobject TDI::Em();
+%newobject TDI::Tm();
+
+%newobject TDI::A1();
+%newobject TDI::E1();
+%newobject TDI::T1();
+
 %newobject TDI::y123();
 %newobject TDI::y231();
 %newobject TDI::y312();
@@ -1168,12 +1517,77 @@ extern void fastgetobsc(double *numarray,long length,long samples,double stime,S
 %newobject TDI::z321();
 %newobject TDI::z132();
 
+%feature("docstring") TDI::observable "
+TDI.observable(name) returns a new TDIobject for the TDI observable
+with the given name (e.g., 'X1', 'alpham', 'Am', 'y123'), or None if
+there is no such observable."
+
+%feature("docstring") TDI::counters "
+counters() returns a dictionary with the event counters (see
+SignalSource.counters and LISA.counters) summed over all the noise and
+LISA objects used by this TDI object (each counted once);
+resetcounters() zeroes them."
+
+%newobject TDI::observable;
+
+%feature("docstring") TDI::combination "
+TDI.combination(terms) returns a new TDIobject for a user-defined TDI
+combination, given as a list of terms
+
+  (coefficient,'y' or 'z',send,link,recv,(ret1,ret2,...))
+
+each standing for coefficient * y(send,link,recv,ret1,ret2,...) (or z),
+with the same conventions as TDI.y and TDI.z (at most seven delays for
+y, eight for z). For instance, the first two terms of alpham are
+
+  [(1.0,'y',3,-2,1,()), (-1.0,'y',2,3,1,())]
+
+The terms are checked (a ValueError is raised if one is not valid) and
+compiled into a native table, which is evaluated like the built-in
+observables (also by fastgetobs, and together with them), on any TDI
+object: TDInoise, TDIsignal and TwoStageTDI evaluate it directly, and
+the other TDI classes through their own y and z.
+
+If a LISA object is given as second argument (the one used for the
+delays), the combination is simplified for its delay symmetries, as
+in TDI.simplified."
+
+%newobject TDI::combination;
+
+%feature("docstring") TDI::simplified "
+TDI.simplified(name,lisa) returns a new TDIobject for the built-in TDI
+observable with the given name (or None if there is no such
+observable), rewritten for the delay symmetries of lisa (see
+LISA.delaysymmetry), which should be the LISA object used for the
+delays. Each delay chain is put in a canonical form (sorted if the
+delays commute, without directions if they do not matter, on a single
+arm if the arms are equal); terms with the same link and canonical
+chain are merged, and dropped if they cancel.
+
+The result equals the original observable up to rounding, but needs
+fewer distinct delayed evaluations per sample (e.g., 9 instead of 17
+delay chains for X1 with OriginalLISA), so idealized constellations
+are sampled faster."
+
+%newobject TDI::simplified;
+
 class TDI {
  public:
     TDI() {};
     virtual ~TDI() {};
 
-    virtual void reset() {};
+    virtual void reset(unsigned long seed = 0) {};
+
+    virtual void resetcounters();
+
+    %extend {
+        PyObject *counters() {
+            EventCounters counters;
+            self->getcounters(counters);
+
+            return counterdict(counters);
+        };
+    };
 
     virtual double alpham(double t);
     TDIobject *alpham();
@@ -1229,6 +1643,24 @@ class TDI {
     virtual double X3(double t);
     TDIobject *X3();
 
+    // A = (gamma - alpha)/sqrt(2), E = (alpha - 2 beta + gamma)/sqrt(6),
+    // T = (alpha + beta + gamma)/sqrt(3), from alpham, betam, gammam (Am,
+    // Em, Tm) and alpha1, alpha2, alpha3 (A1, E1, T1)
+
+    virtual double Am(double t);
+    TDIobject *Am();
+    virtual double Em(double t);
+    TDIobject *Em();
+    virtual double Tm(double t);
+    TDIobject *Tm();
+
+    virtual double A1(double t);
+    TDIobject *A1();
+    virtual double E1(double t);
+    TDIobject *E1();
+    virtual double T1(double t);
+    TDIobject *T1();
+
     virtual double y(int send, int link, int recv, int ret1, int ret2, int ret3, double t);
     virtual double z(int send, int link, int recv, int ret1, int ret2, int ret3, int ret4, double t);
 
@@ -1267,6 +1699,12 @@ class TDI {
     timeobject *time();
     double t(double t);
     timeobject *t();
+
+    TDIobject *observable(const char *name);
+
+    TDIobject *combination(const TDIterm *theterms,int terms,LISA *geometry = 0);
+
+    TDIobject *simplified(const char *name,LISA *geometry);
 };
 
 initsave(SampledTDI)
@@ -1297,6 +1735,45 @@ class TDIquantize : public TDI {
     ~TDIquantize();
 };
 
+%feature("docstring") TwoStageTDI "
+TwoStageTDI(lisa,basetdi,bufferlen,deltat,interplen = 4)
+
+returns a TDI object that evaluates the TDI observables in two stages,
+as in the processing of the real instrument: first, the six y and the
+six z link measurements of the TDI object basetdi (e.g., a TDInoise or
+TDIsignal object) are sampled together every deltat seconds, once each;
+then, the observables are formed from these twelve streams by applying
+the delays of the LISA object lisa (e.g., a CacheLengthLISA object)
+with Lagrange fractional-delay filters over 2*interplen samples.
+
+The cost of basetdi is then paid once per link and sample, rather than
+once per term of each observable. In the second stage, the delays and
+filter weights are computed once per sample for each distinct delay
+chain, and shared by the terms that use it, so the per-term cost is a
+2*interplen-tap sum. The sampled links are kept in a
+buffer of bufferlen samples, which must span the longest delay chain of
+the observables used (about eight armlengths for X1) plus interplen
+samples. The streams begin eight armlengths plus interplen samples
+before t = 0, so the observables can be evaluated from t = 0 on.
+
+Laser noise cancels only to the extent that the fractional-delay filters
+reproduce it, so it should be band-limited well below the Nyquist
+frequency of deltat (e.g., by generating it with a sampling time
+several times longer than deltat).
+"
+
+initdoc(TwoStageTDI)
+
+initsave(TwoStageTDI)
+
+exceptionhandle(TwoStageTDI::TwoStageTDI,ExceptionUndefined,PyExc_ValueError)
+
+class TwoStageTDI : public TDI {
+ public:
+    TwoStageTDI(LISA *lisa,TDI *basetdi,long length,double deltat,int interplen = 4);
+    ~TwoStageTDI();
+};
+
 %feature("docstring") TDInoise "
 TDInoise(lisa,PMnoise[6],      SHnoise[6],      LSnoise[6])
 TDInoise(lisa,PMdt,   PMpsd,   SHdt,   SHpsd,   LSdt,   LSpsd)
@@ -5,630 +5,1690 @@
  */
 
 #include "lisasim-tdi.h"
+#include "lisasim-tdinoise.h"
 
-#include <Python.h>
+#include <time.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <string>
+#include <typeinfo>
+
+// --- TDI combination tables ---
+
+TDItable::TDItable(const char *n,const TDIterm *terms,int count) : name(n), steps(count) {
+    for(int k=0;k<count;k++) {
+        const TDIterm &term = terms[k];
+        TDIstep &step = steps[k];
+
+        step.scale = term.scale;
+        step.block = term.block;
+        step.sign = term.sign;
+
+        step.z = (term.kind == 'z');
+
+        step.send = term.send;
+        step.slink = term.link;
+        step.link = abs(term.link);
+        step.recv = term.recv;
+
+        // same tests as TDInoise::y and TDIsignal::y
+
+        step.cyclic = (step.link == 3 && step.recv == 1) || (step.link == 2 && step.recv == 3) || (step.link == 1 && step.recv == 2);
+
+        if( (step.link == 3 && step.recv == 2) || (step.link == 1 && step.recv == 3) || (step.link == 2 && step.recv == 1) )
+            step.olink = -step.link;
+        else
+            step.olink = step.link;
+
+        // retard(ret1) is applied last; retard(0) does nothing
+
+        step.delays = 0;
+
+        for(int r=7;r>=0;r--) {
+            step.ret[r] = term.ret[r];
+            if(term.ret[r] != 0) step.delay[step.delays++] = term.ret[r];
+        }
+    }
+}
+
+TDItable::TDItable(const char *n,const TDItable *const *parts,const double *coeffs,int count) : name(n) {
+    for(int k=0;k<count;k++) {
+        std::vector<TDIstep>::size_type first = steps.size();
+
+        steps.insert(steps.end(),parts[k]->steps.begin(),parts[k]->steps.end());
+
+        // each part begins a new group and a new block (evaltable starts
+        // from scale 1 and sign 1)
+
+        if(steps[first].scale == 0.0) steps[first].scale = 1.0;
+        if(steps[first].block == 0) steps[first].block = 1;
+
+        for(std::vector<TDIstep>::size_type i=first;i<steps.size();i++)
+            if(steps[i].scale != 0.0) steps[i].scale *= coeffs[k];
+    }
+}
+
+// simplification: canonical delay chains (in the order they are applied)
+
+static int canonicaldelays(const TDIstep &step,int symmetry,int *delay) {
+    for(int k=0;k<step.delays;k++) {
+        int d = step.delay[k];
+
+        if(symmetry & delayequal) d = (d > 0) ? 1 : -1;
+        if(symmetry & delaysymmetric) d = abs(d);
+
+        delay[k] = d;
+    }
+
+    if(symmetry & delaystatic) {
+        for(int k=1;k<step.delays;k++)
+            for(int j=k;j>0 && delay[j-1] > delay[j];j--) {
+                int swap = delay[j]; delay[j] = delay[j-1]; delay[j-1] = swap;
+            }
+    }
+
+    return step.delays;
+}
+
+TDItable *simplifytable(const TDItable &table,int symmetry) {
+    std::vector<TDIterm> terms;
+
+    double scale = 1.0;
+    int block = 1;
+
+    for(unsigned int k=0;k<table.steps.size();k++) {
+        const TDIstep &step = table.steps[k];
+
+        if(step.block) block = step.block;
+        if(step.scale != 0.0) scale = step.scale;
+
+        // one group per term, as in TDI::combination
+
+        TDIterm term = {scale * block * step.sign, 1, 1, step.z ? 'z' : 'y', step.send, step.slink, step.recv, {0,0,0,0,0,0,0,0}};
+
+        // ret1 is applied last (see the TDItable constructor)
+
+        int delay[8];
+        int delays = canonicaldelays(step,symmetry,delay);
+
+        for(int d=0;d<delays;d++)
+            term.ret[delays-1-d] = delay[d];
+
+        // the sign of link does not enter y and z (see TDInoise::y and TDIsignal::y)
+
+        unsigned int u = 0;
+
+        for(;u<terms.size();u++) {
+            const TDIterm &other = terms[u];
+
+            if(other.kind == term.kind && other.send == term.send && abs(other.link) == abs(term.link) &&
+               other.recv == term.recv && !memcmp(other.ret,term.ret,sizeof(term.ret)))
+                break;
+        }
+
+        if(u < terms.size())
+            terms[u].scale += term.scale;
+        else
+            terms.push_back(term);
+    }
+
+    // in the built-in tables the coefficients are small multiples of 0.5,
+    // so their cancellations are exact
+
+    std::vector<TDIterm> kept;
+
+    for(unsigned int u=0;u<terms.size();u++)
+        if(terms[u].scale != 0.0) kept.push_back(terms[u]);
+
+    return new TDItable(table.name,kept.empty() ? 0 : &kept[0],kept.size());
+}
+
+// each term is {scale, block, sign, kind, send, link, recv, {ret1, ret2, ...}}
+
+// in these expressions the order of the delays is physically
+// motivated, but the combination still does not cancel laser
+// noise (from the final ref. lasers) in ModifiedLISA
+
+static const TDIterm alphamterms[] = {
+    { 1.0, 1, 1,'y',3,-2,1,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2,-1,3,{-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{ 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1,-3,2,{-1,-2, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{ 1, 3, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',2, 3,1,{-3,-1,-2, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{ 2, 1, 3, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{-1,-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2,-1,3,{ 1, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{ 1, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1,-3,2,{-1,-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{ 3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2,-1,3,{-2, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{-2, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1,-3,2,{ 3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{ 0, 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable alphamtable("alpham",alphamterms,sizeof(alphamterms)/sizeof(TDIterm));
+
+double TDI::alpham(double t) {
+    return evaltable(this,alphamtable,t);
+}
+
+static const TDIterm betamterms[] = {
+    { 1.0, 1, 1,'y',1,-3,2,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3,-2,1,{-3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{ 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2,-1,3,{-2,-3, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{ 2, 1, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',3, 1,2,{-1,-2,-3, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1,-3,2,{ 3, 2, 1, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{-2,-3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{ 2, 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{ 2, 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2,-1,3,{-2,-3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{ 1, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{-3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{-3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2,-1,3,{ 1, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1,-3,2,{ 0, 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable betamtable("betam",betamterms,sizeof(betamterms)/sizeof(TDIterm));
+
+double TDI::betam(double t) {
+    return evaltable(this,betamtable,t);
+}
+
+static const TDIterm gammamterms[] = {
+    { 1.0, 1, 1,'y',2,-1,3,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1,-3,2,{-1, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{ 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3,-2,1,{-3,-1, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{ 3, 2, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',1, 2,3,{-2,-3,-1, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2,-1,3,{ 1, 3, 2, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{-3,-1, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1,-3,2,{ 3, 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{ 3, 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{-3,-1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{ 2, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1,-3,2,{-1, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{-1, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{ 2, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2,-1,3,{ 0, 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable gammamtable("gammam",gammamterms,sizeof(gammamterms)/sizeof(TDIterm));
+
+double TDI::gammam(double t) {
+    return evaltable(this,gammamtable,t);
+}
+
+// how to set the sign of the retardations here?
+
+static const TDIterm zetamterms[] = {
+    { 1.0, 1, 1,'y',1,-3,2,{ 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{ 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2,-1,3,{ 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{ 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3,-2,1,{ 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{ 2, 0, 0, 0, 0, 0, 0}},
+    { 0.5,-1, 1,'z',2,-1,3,{ 2, 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{ 1, 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{ 2, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{ 2, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1,-3,2,{ 1, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{ 1, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.5,-1, 1,'z',1,-3,2,{ 2, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{ 2, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2,-1,3,{ 3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{ 3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{ 1, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{ 1, 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable zetamtable("zetam",zetamterms,sizeof(zetamterms)/sizeof(TDIterm));
+
+double TDI::zetam(double t) {
+    return evaltable(this,zetamtable,t);
+}
+
+static const TDIterm alpha1terms[] = {
+    { 1.0, 1, 1,'y',1,-3,2,{-1,-2, 2, 1, 3, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{ 1, 3,-3,-1,-2, 0, 0}},
+    { 0.0, 1, 1,'y',2,-1,3,{-2, 2, 1, 3, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{ 3,-3,-1,-2, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3,-2,1,{ 2, 1, 3, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{-3,-1,-2, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1, 2,3,{ 1, 3, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1,-3,2,{-1,-2, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3, 1,2,{ 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2,-1,3,{-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2, 3,1,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3,-2,1,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',2, 3,1,{-3,-1,-2, 2, 1, 3, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{ 2, 1, 3,-3,-1,-2, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{ 1, 3,-3,-1,-2, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1,-3,2,{-1,-2, 2, 1, 3, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{-1,-2, 2, 1, 3, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2,-1,3,{ 1, 3,-3,-1,-2, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{-2, 2, 1, 3, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2,-1,3,{-2, 2, 1, 3, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{ 3,-3,-1,-2, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1,-3,2,{ 3,-3,-1,-2, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1,-3,2,{-1,-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{-1,-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2,-1,3,{ 1, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1, 2,3,{ 1, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1,-3,2,{ 3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1, 2,3,{-2, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2,-1,3,{-2, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{ 3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3,-2,1,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{ 0, 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable alpha1table("alpha1",alpha1terms,sizeof(alpha1terms)/sizeof(TDIterm));
+
+double TDI::alpha1(double t) {
+    return evaltable(this,alpha1table,t);
+}
+
+static const TDIterm alpha2terms[] = {
+    { 1.0, 1, 1,'y',2,-1,3,{-2,-3, 3, 2, 1, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{ 2, 1,-1,-2,-3, 0, 0}},
+    { 0.0, 1, 1,'y',3,-2,1,{-3, 3, 2, 1, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{ 1,-1,-2,-3, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1,-3,2,{ 3, 2, 1, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{-1,-2,-3, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2, 3,1,{ 2, 1, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2,-1,3,{-2,-3, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1, 2,3,{ 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3,-2,1,{-3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3, 1,2,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1,-3,2,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',3, 1,2,{-1,-2,-3, 3, 2, 1, 0, 0}},
+    { 0.0,-1, 1,'z',1,-3,2,{ 3, 2, 1,-1,-2,-3, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{ 2, 1,-1,-2,-3, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2,-1,3,{-2,-3, 3, 2, 1, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{-2,-3, 3, 2, 1, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{ 2, 1,-1,-2,-3, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{-3, 3, 2, 1, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{-3, 3, 2, 1, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{ 1,-1,-2,-3, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2,-1,3,{ 1,-1,-2,-3, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2,-1,3,{-2,-3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1, 2,3,{-2,-3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3,-2,1,{ 2, 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{ 2, 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2,-1,3,{ 1, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{-3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3,-2,1,{-3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1, 2,3,{ 1, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1,-3,2,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{ 0, 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable alpha2table("alpha2",alpha2terms,sizeof(alpha2terms)/sizeof(TDIterm));
+
+double TDI::alpha2(double t) {
+    return evaltable(this,alpha2table,t);
+}
+
+static const TDIterm alpha3terms[] = {
+    { 1.0, 1, 1,'y',3,-2,1,{-3,-1, 1, 3, 2, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{ 3, 2,-2,-3,-1, 0, 0}},
+    { 0.0, 1, 1,'y',1,-3,2,{-1, 1, 3, 2, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{ 2,-2,-3,-1, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2,-1,3,{ 1, 3, 2, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{-2,-3,-1, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3, 1,2,{ 3, 2, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3,-2,1,{-3,-1, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2, 3,1,{ 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1,-3,2,{-1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1, 2,3,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2,-1,3,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',1, 2,3,{-2,-3,-1, 1, 3, 2, 0, 0}},
+    { 0.0,-1, 1,'z',2,-1,3,{ 1, 3, 2,-2,-3,-1, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{ 3, 2,-2,-3,-1, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{-3,-1, 1, 3, 2, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{-3,-1, 1, 3, 2, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1,-3,2,{ 3, 2,-2,-3,-1, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{-1, 1, 3, 2, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1,-3,2,{-1, 1, 3, 2, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{ 2,-2,-3,-1, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{ 2,-2,-3,-1, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3,-2,1,{-3,-1, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{-3,-1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1,-3,2,{ 3, 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{ 3, 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3,-2,1,{ 2, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{-1, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1,-3,2,{-1, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{ 2, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2,-1,3,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1, 2,3,{ 0, 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable alpha3table("alpha3",alpha3terms,sizeof(alpha3terms)/sizeof(TDIterm));
+
+double TDI::alpha3(double t) {
+    return evaltable(this,alpha3table,t);
+}
+
+static const TDIterm zeta1terms[] = {
+    { 1.0, 1, 1,'y',3,-2,1,{ 1, 2, 3, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'y',3, 1,2,{-2, 2, 3, 0, 0, 0, 0}},
+    { 0.0, 0, 1,'y',1,-3,2,{-2, 2, 3, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{ 3,-3,-2, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'y',2,-1,3,{ 3,-3,-2, 0, 0, 0, 0}},
+    { 0.0, 0, 1,'y',2, 3,1,{-1,-3,-2, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3,-2,1,{ 1,-1, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'y',3, 1,2,{-2,-1, 0, 0, 0, 0, 0}},
+    { 0.0, 0, 1,'y',1,-3,2,{-2,-1, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1, 2,3,{ 3, 1, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'y',2,-1,3,{ 3, 1, 0, 0, 0, 0, 0}},
+    { 0.0, 0, 1,'y',2, 3,1,{-1, 1, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',3, 1,2,{-2, 2, 3, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',1,-3,2,{-2, 2, 3, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{-2,-1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',1,-3,2,{-2,-1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{-1, 3,-3,-2, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',1,-3,2,{-1, 3,-3,-2, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{-1, 3, 1, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',1,-3,2,{-1, 3, 1, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{-2, 2, 3, 1, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',2,-1,3,{-2, 2, 3, 1, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1, 2,3,{-2,-1, 1, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',2,-1,3,{-2,-1, 1, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{-2,-3, 3, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',2,-1,3,{-2,-3, 3, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1, 2,3,{ 3, 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',2,-1,3,{ 3, 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{-2, 2,-3, 3, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',3,-2,1,{-2, 2,-3, 3, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{-1, 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',3,-2,1,{-1, 1, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable zeta1table("zeta1",zeta1terms,sizeof(zeta1terms)/sizeof(TDIterm));
+
+double TDI::zeta1(double t) {
+    return evaltable(this,zeta1table,t);
+}
+
+static const TDIterm zeta2terms[] = {
+    { 1.0, 1, 1,'y',1,-3,2,{ 2, 3, 1, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'y',1, 2,3,{-3, 3, 1, 0, 0, 0, 0}},
+    { 0.0, 0, 1,'y',2,-1,3,{-3, 3, 1, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{ 1,-1,-3, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'y',3,-2,1,{ 1,-1,-3, 0, 0, 0, 0}},
+    { 0.0, 0, 1,'y',3, 1,2,{-2,-1,-3, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1,-3,2,{ 2,-2, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'y',1, 2,3,{-3,-2, 0, 0, 0, 0, 0}},
+    { 0.0, 0, 1,'y',2,-1,3,{-3,-2, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2, 3,1,{ 1, 2, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'y',3,-2,1,{ 1, 2, 0, 0, 0, 0, 0}},
+    { 0.0, 0, 1,'y',3, 1,2,{-2, 2, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',1, 2,3,{-3, 3, 1, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',2,-1,3,{-3, 3, 1, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1, 2,3,{-3,-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',2,-1,3,{-3,-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{-2, 1,-1,-3, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',2,-1,3,{-2, 1,-1,-3, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1, 2,3,{-2, 1, 2, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',2,-1,3,{-2, 1, 2, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{-3, 3, 1, 2, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',3,-2,1,{-3, 3, 1, 2, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{-3,-2, 2, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',3,-2,1,{-3,-2, 2, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{-3,-1, 1, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',3,-2,1,{-3,-1, 1, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{ 1, 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',3,-2,1,{ 1, 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{-3, 3,-1, 1, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',1,-3,2,{-3, 3,-1, 1, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{-2, 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',1,-3,2,{-2, 2, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable zeta2table("zeta2",zeta2terms,sizeof(zeta2terms)/sizeof(TDIterm));
+
+double TDI::zeta2(double t) {
+    return evaltable(this,zeta2table,t);
+}
+
+static const TDIterm zeta3terms[] = {
+    { 1.0, 1, 1,'y',2,-1,3,{ 3, 1, 2, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'y',2, 3,1,{-1, 1, 2, 0, 0, 0, 0}},
+    { 0.0, 0, 1,'y',3,-2,1,{-1, 1, 2, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{ 2,-2,-1, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'y',1,-3,2,{ 2,-2,-1, 0, 0, 0, 0}},
+    { 0.0, 0, 1,'y',1, 2,3,{-3,-2,-1, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2,-1,3,{ 3,-3, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'y',2, 3,1,{-1,-3, 0, 0, 0, 0, 0}},
+    { 0.0, 0, 1,'y',3,-2,1,{-1,-3, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3, 1,2,{ 2, 3, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'y',1,-3,2,{ 2, 3, 0, 0, 0, 0, 0}},
+    { 0.0, 0, 1,'y',1, 2,3,{-3, 3, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',2, 3,1,{-1, 1, 2, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',3,-2,1,{-1, 1, 2, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{-1,-3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',3,-2,1,{-1,-3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{-3, 2,-2,-1, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',3,-2,1,{-3, 2,-2,-1, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{-3, 2, 3, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',3,-2,1,{-3, 2, 3, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{-1, 1, 2, 3, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',1,-3,2,{-1, 1, 2, 3, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{-1,-3, 3, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',1,-3,2,{-1,-3, 3, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{-1,-2, 2, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',1,-3,2,{-1,-2, 2, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{ 2, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',1,-3,2,{ 2, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{-1, 1,-2, 2, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',2,-1,3,{-1, 1,-2, 2, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1, 2,3,{-3, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 0,-1,'z',2,-1,3,{-3, 3, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable zeta3table("zeta3",zeta3terms,sizeof(zeta3terms)/sizeof(TDIterm));
+
+double TDI::zeta3(double t) {
+    return evaltable(this,zeta3table,t);
+}
+
+// to be updated with physical-delay expressions
+// and with multiple arm expressions
+
+static const TDIterm Pterms[] = {
+    { 1.0, 1, 1,'y',1, 3,2,{ 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{ 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{ 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2, 1,3,{ 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3, 1,2,{ 1, 3, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 1,3,{ 1, 2, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1, 2,3,{ 3, 1, 1, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 3,2,{ 2, 1, 1, 0, 0, 0, 0}},
+    { 0.5,-1, 1,'z',3, 2,1,{ 2, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 2,1,{ 1, 1, 2, 3, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{ 2, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{ 1, 1, 2, 3, 0, 0, 0, 0}},
+    { 0.5,-1, 1,'z',1, 3,2,{ 2, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 3,2,{ 1, 1, 2, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{ 2, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{ 1, 1, 2, 0, 0, 0, 0, 0}},
+    { 0.5,-1, 1,'z',2, 1,3,{ 3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 1,3,{ 1, 1, 3, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{ 3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1, 2,3,{ 1, 1, 3, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable Ptable("P",Pterms,sizeof(Pterms)/sizeof(TDIterm));
+
+double TDI::P(double t) {
+    return evaltable(this,Ptable,t);
+}
+
+static const TDIterm Eterms[] = {
+    { 1.0, 1, 1,'y',3, 1,2,{ 2, 1, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 1,3,{ 3, 1, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{ 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2, 1,3,{ 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2, 3,1,{ 1, 1, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 2,1,{ 1, 1, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3, 2,1,{ 0, 0, 0, 0, 0, 0, 0}},
+    {-0.5, 1, 1,'z',2, 1,3,{ 2, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 2,1,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 3,2,{ 3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 1,3,{ 1, 1, 2, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{ 1, 1, 2, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1, 3,2,{ 1, 1, 3, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',1, 2,3,{ 2, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{ 3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{ 1, 1, 3, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 2,1,{ 1, 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{ 1, 1, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable Etable("E",Eterms,sizeof(Eterms)/sizeof(TDIterm));
+
+double TDI::E(double t) {
+    return evaltable(this,Etable,t);
+}
+
+static const TDIterm Uterms[] = {
+    { 1.0, 1, 1,'y',3, 2,1,{ 1, 1, 3, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 2,1,{ 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{ 1, 2, 3, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2, 1,3,{ 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 1,3,{ 2, 3, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1, 3,2,{ 1, 1, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 3,2,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3, 1,2,{ 0, 0, 0, 0, 0, 0, 0}},
+    {-0.5, 1, 1,'z',2, 3,1,{ 3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{ 2, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 3,2,{ 1, 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 1,3,{ 1, 1, 2, 3, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 2,1,{ 1, 1, 3, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',3, 2,1,{ 3, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 3,2,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 1,3,{ 2, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{ 1, 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{ 1, 1, 2, 3, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{ 1, 1, 3, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable Utable("U",Uterms,sizeof(Uterms)/sizeof(TDIterm));
+
+double TDI::U(double t) {
+    return evaltable(this,Utable,t);
+}
+
+static const TDIterm Xmterms[] = {
+    { 1.0, 1, 1,'y',1,-3,2,{ 3, 2,-2, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{-2,-3, 3, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2, 3,1,{ 2,-2, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3,-2,1,{-3, 3, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1, 2,3,{-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1,-3,2,{ 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3,-2,1,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.5,-1, 1,'z',3,-2,1,{ 2,-2,-3, 3, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3,-2,1,{-3, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3,-2,1,{ 2,-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',2, 3,1,{-3, 3, 2,-2, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{-3, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{ 2,-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{ 0, 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable Xmtable("Xm",Xmterms,sizeof(Xmterms)/sizeof(TDIterm));
+
+double TDI::Xm(double t) {
+    return evaltable(this,Xmtable,t);
+}
+
+static const TDIterm Xmlock1terms[] = {
+    { 1.0, 1, 1,'y',2, 3,1,{ 2,-2, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3,-2,1,{-3, 3, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3,-2,1,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{ 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable Xmlock1table("Xmlock1",Xmlock1terms,sizeof(Xmlock1terms)/sizeof(TDIterm));
+
+double TDI::Xmlock1(double t) {
+    return evaltable(this,Xmlock1table,t);
+}
+
+static const TDIterm Xmlock2terms[] = {
+    { 1.0, 1, 1,'y',1,-3,2,{ 3, 2,-2, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{-2,-3, 3, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3,-2,1,{-3, 3, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1, 2,3,{-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1,-3,2,{ 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3,-2,1,{ 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable Xmlock2table("Xmlock2",Xmlock2terms,sizeof(Xmlock2terms)/sizeof(TDIterm));
+
+double TDI::Xmlock2(double t) {
+    return evaltable(this,Xmlock2table,t);
+}
+
+static const TDIterm Xmlock3terms[] = {
+    { 1.0, 1, 1,'y',1,-3,2,{ 3, 2,-2, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{-2,-3, 3, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2, 3,1,{ 2,-2, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1, 2,3,{-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1,-3,2,{ 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{ 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable Xmlock3table("Xmlock3",Xmlock3terms,sizeof(Xmlock3terms)/sizeof(TDIterm));
+
+double TDI::Xmlock3(double t) {
+    return evaltable(this,Xmlock3table,t);
+}
+
+static const TDIterm Ymterms[] = {
+    { 1.0, 1, 1,'y',2,-1,3,{ 1, 3,-3, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{-3,-1, 1, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3, 1,2,{ 3,-3, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1,-3,2,{-1, 1, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2, 3,1,{-3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2,-1,3,{ 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1,-3,2,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',3, 1,2,{-1, 1, 3,-3, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{-1, 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{ 3,-3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.5,-1, 1,'z',1,-3,2,{ 3,-3,-1, 1, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1,-3,2,{-1, 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1,-3,2,{ 3,-3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1,-3,2,{ 0, 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable Ymtable("Ym",Ymterms,sizeof(Ymterms)/sizeof(TDIterm));
+
+double TDI::Ym(double t) {
+    return evaltable(this,Ymtable,t);
+}
+
+static const TDIterm Zmterms[] = {
+    { 1.0, 1, 1,'y',3,-2,1,{ 2, 1,-1, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{-1,-2, 2, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1, 2,3,{ 1,-1, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2,-1,3,{-2, 2, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3, 1,2,{-1, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3,-2,1,{ 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2,-1,3,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.5,-1, 1,'z',2,-1,3,{ 1,-1,-2, 2, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2,-1,3,{ 1,-1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2,-1,3,{-2, 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2,-1,3,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',1, 2,3,{-2, 2, 1,-1, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1, 2,3,{-2, 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1, 2,3,{ 1,-1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{ 0, 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable Zmtable("Zm",Zmterms,sizeof(Zmterms)/sizeof(TDIterm));
+
+double TDI::Zm(double t) {
+    return evaltable(this,Zmtable,t);
+}
+
+static const TDIterm X1terms[] = {
+    { 1.0, 1, 1,'y',1,-3,2,{ 3, 2,-2, 2,-2,-3, 3}},
+    { 0.0,-1, 1,'y',1, 2,3,{-2,-3, 3,-3, 3, 2,-2}},
+    { 0.0, 1, 1,'y',2, 3,1,{ 2,-2, 2,-2,-3, 3, 0}},
+    { 0.0,-1, 1,'y',3,-2,1,{-3, 3,-3, 3, 2,-2, 0}},
+    { 0.0, 1, 1,'y',1, 2,3,{-2, 2,-2,-3, 3, 0, 0}},
+    { 0.0,-1, 1,'y',1,-3,2,{ 3,-3, 3, 2,-2, 0, 0}},
+    { 0.0, 1, 1,'y',3,-2,1,{ 2,-2,-3, 3, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{-3, 3, 2,-2, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1, 2,3,{-2,-3, 3, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1,-3,2,{ 3, 2,-2, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3,-2,1,{-3, 3, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{ 2,-2, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1,-3,2,{ 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2, 3,1,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3,-2,1,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',2, 3,1,{-3, 3, 2,-2, 2,-2,-3, 3}},
+    { 0.0,-1, 1,'z',2, 3,1,{-3, 3,-3, 3, 2,-2, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{ 2,-2, 2,-2,-3, 3, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{-3, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2, 3,1,{ 2,-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2, 3,1,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.5,-1, 1,'z',3,-2,1,{ 2,-2,-3, 3,-3, 3, 2,-2}},
+    { 0.0, 1, 1,'z',3,-2,1,{-3, 3,-3, 3, 2,-2, 0, 0}},
+    { 0.0, 1, 1,'z',3,-2,1,{ 2,-2, 2,-2,-3, 3, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{-3, 3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3,-2,1,{ 2,-2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3,-2,1,{ 0, 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable X1table("X1",X1terms,sizeof(X1terms)/sizeof(TDIterm));
+
+double TDI::X1(double t) {
+    return evaltable(this,X1table,t);
+}
+
+static const TDIterm X2terms[] = {
+    { 1.0, 1, 1,'y',2,-1,3,{ 1, 3,-3, 3,-3,-1, 1}},
+    { 0.0,-1, 1,'y',2, 3,1,{-3,-1, 1,-1, 1, 3,-3}},
+    { 0.0, 1, 1,'y',3, 1,2,{ 3,-3, 3,-3,-1, 1, 0}},
+    { 0.0,-1, 1,'y',1,-3,2,{-1, 1,-1, 1, 3,-3, 0}},
+    { 0.0, 1, 1,'y',2, 3,1,{-3, 3,-3,-1, 1, 0, 0}},
+    { 0.0,-1, 1,'y',2,-1,3,{ 1,-1, 1, 3,-3, 0, 0}},
+    { 0.0, 1, 1,'y',1,-3,2,{ 3,-3,-1, 1, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{-1, 1, 3,-3, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2, 3,1,{-3,-1, 1, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2,-1,3,{ 1, 3,-3, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1,-3,2,{-1, 1, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{ 3,-3, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2,-1,3,{ 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2, 3,1,{-3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3, 1,2,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1,-3,2,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',3, 1,2,{-1, 1, 3,-3, 3,-3,-1, 1}},
+    { 0.0,-1, 1,'z',3, 1,2,{-1, 1,-1, 1, 3,-3, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{ 3,-3, 3,-3,-1, 1, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{-1, 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',3, 1,2,{ 3,-3, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',3, 1,2,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.5,-1, 1,'z',1,-3,2,{ 3,-3,-1, 1,-1, 1, 3,-3}},
+    { 0.0, 1, 1,'z',1,-3,2,{-1, 1,-1, 1, 3,-3, 0, 0}},
+    { 0.0, 1, 1,'z',1,-3,2,{ 3,-3, 3,-3,-1, 1, 0, 0}},
+    { 0.0,-1, 1,'z',1,-3,2,{-1, 1, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1,-3,2,{ 3,-3, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1,-3,2,{ 0, 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable X2table("X2",X2terms,sizeof(X2terms)/sizeof(TDIterm));
+
+double TDI::X2(double t) {
+    return evaltable(this,X2table,t);
+}
+
+static const TDIterm X3terms[] = {
+    { 1.0, 1, 1,'y',3,-2,1,{ 2, 1,-1, 1,-1,-2, 2}},
+    { 0.0,-1, 1,'y',3, 1,2,{-1,-2, 2,-2, 2, 1,-1}},
+    { 0.0, 1, 1,'y',1, 2,3,{ 1,-1, 1,-1,-2, 2, 0}},
+    { 0.0,-1, 1,'y',2,-1,3,{-2, 2,-2, 2, 1,-1, 0}},
+    { 0.0, 1, 1,'y',3, 1,2,{-1, 1,-1,-2, 2, 0, 0}},
+    { 0.0,-1, 1,'y',3,-2,1,{ 2,-2, 2, 1,-1, 0, 0}},
+    { 0.0, 1, 1,'y',2,-1,3,{ 1,-1,-2, 2, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{-2, 2, 1,-1, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3, 1,2,{-1,-2, 2, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3,-2,1,{ 2, 1,-1, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',2,-1,3,{-2, 2, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',1, 2,3,{ 1,-1, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',3,-2,1,{ 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',3, 1,2,{-1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'y',1, 2,3,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'y',2,-1,3,{ 0, 0, 0, 0, 0, 0, 0}},
+    { 0.5, 1, 1,'z',1, 2,3,{-2, 2, 1,-1, 1,-1,-2, 2}},
+    { 0.0,-1, 1,'z',1, 2,3,{-2, 2,-2, 2, 1,-1, 0, 0}},
+    { 0.0,-1, 1,'z',1, 2,3,{ 1,-1, 1,-1,-2, 2, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{-2, 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',1, 2,3,{ 1,-1, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',1, 2,3,{ 0, 0, 0, 0, 0, 0, 0, 0}},
+    { 0.5,-1, 1,'z',2,-1,3,{ 1,-1,-2, 2,-2, 2, 1,-1}},
+    { 0.0, 1, 1,'z',2,-1,3,{-2, 2,-2, 2, 1,-1, 0, 0}},
+    { 0.0, 1, 1,'z',2,-1,3,{ 1,-1, 1,-1,-2, 2, 0, 0}},
+    { 0.0,-1, 1,'z',2,-1,3,{-2, 2, 0, 0, 0, 0, 0, 0}},
+    { 0.0,-1, 1,'z',2,-1,3,{ 1,-1, 0, 0, 0, 0, 0, 0}},
+    { 0.0, 1, 1,'z',2,-1,3,{ 0, 0, 0, 0, 0, 0, 0, 0}}
+};
+
+static const TDItable X3table("X3",X3terms,sizeof(X3terms)/sizeof(TDIterm));
+
+double TDI::X3(double t) {
+    return evaltable(this,X3table,t);
+}
+
+// A, E, T from the Sagnac combinations
+
+static const double Acoeffs[] = {-1.0/sqrt(2.0), 1.0/sqrt(2.0)};
+static const double Ecoeffs[] = {1.0/sqrt(6.0), -2.0/sqrt(6.0), 1.0/sqrt(6.0)};
+static const double Tcoeffs[] = {1.0/sqrt(3.0), 1.0/sqrt(3.0), 1.0/sqrt(3.0)};
+
+static const TDItable *Amparts[] = {&alphamtable, &gammamtable};
+static const TDItable *EmTmparts[] = {&alphamtable, &betamtable, &gammamtable};
+
+static const TDItable Amtable("Am",Amparts,Acoeffs,2);
+static const TDItable Emtable("Em",EmTmparts,Ecoeffs,3);
+static const TDItable Tmtable("Tm",EmTmparts,Tcoeffs,3);
+
+double TDI::Am(double t) {
+    return evaltable(this,Amtable,t);
+}
+
+double TDI::Em(double t) {
+    return evaltable(this,Emtable,t);
+}
+
+double TDI::Tm(double t) {
+    return evaltable(this,Tmtable,t);
+}
+
+static const TDItable *A1parts[] = {&alpha1table, &alpha3table};
+static const TDItable *E1T1parts[] = {&alpha1table, &alpha2table, &alpha3table};
+
+static const TDItable A1table("A1",A1parts,Acoeffs,2);
+static const TDItable E1table("E1",E1T1parts,Ecoeffs,3);
+static const TDItable T1table("T1",E1T1parts,Tcoeffs,3);
+
+double TDI::A1(double t) {
+    return evaltable(this,A1table,t);
+}
+
+double TDI::E1(double t) {
+    return evaltable(this,E1table,t);
+}
+
+double TDI::T1(double t) {
+    return evaltable(this,T1table,t);
+}
+
+static const TDItable *tditables[] = {
+    &alphamtable, &betamtable, &gammamtable, &zetamtable, &alpha1table,
+    &alpha2table, &alpha3table, &zeta1table, &zeta2table, &zeta3table,
+    &Ptable, &Etable, &Utable, &Xmtable, &Ymtable, &Zmtable, &Xmlock1table,
+    &Xmlock2table, &Xmlock3table, &X1table, &X2table, &X3table,
+    &Amtable, &Emtable, &Tmtable, &A1table, &E1table, &T1table,
+    0
+};
+
+const TDItable *findtditable(const char *name) {
+    for(const TDItable **t = tditables; *t; t++)
+        if(!strcmp((*t)->name,name))
+            return *t;
+
+    return 0;
+}
+
+// lookup table for TDI::observable
+
+struct TDIobservable {
+    const char *name;
+    double (TDI::*obs)(double t);
+};
+
+static TDIobservable tdiobservables[] = {
+    {"alpham",&TDI::alpham}, {"betam",&TDI::betam}, {"gammam",&TDI::gammam},
+    {"zetam",&TDI::zetam},
+    {"alpha1",&TDI::alpha1}, {"alpha2",&TDI::alpha2}, {"alpha3",&TDI::alpha3},
+    {"zeta1",&TDI::zeta1}, {"zeta2",&TDI::zeta2}, {"zeta3",&TDI::zeta3},
+    {"P",&TDI::P}, {"E",&TDI::E}, {"U",&TDI::U},
+    {"Xm",&TDI::Xm}, {"Ym",&TDI::Ym}, {"Zm",&TDI::Zm},
+    {"Xmlock1",&TDI::Xmlock1}, {"Xmlock2",&TDI::Xmlock2}, {"Xmlock3",&TDI::Xmlock3},
+    {"X1",&TDI::X1}, {"X2",&TDI::X2}, {"X3",&TDI::X3},
+    {"Am",&TDI::Am}, {"Em",&TDI::Em}, {"Tm",&TDI::Tm},
+    {"A1",&TDI::A1}, {"E1",&TDI::E1}, {"T1",&TDI::T1},
+    {"y123",&TDI::y123}, {"y231",&TDI::y231}, {"y312",&TDI::y312},
+    {"y321",&TDI::y321}, {"y132",&TDI::y132}, {"y213",&TDI::y213},
+    {"z123",&TDI::z123}, {"z231",&TDI::z231}, {"z312",&TDI::z312},
+    {"z321",&TDI::z321}, {"z132",&TDI::z132}, {"z213",&TDI::z213},
+    {0,0}
+};
+
+TDIobject *TDI::observable(const char *name) {
+    const TDItable *table = findtditable(name);
+
+    TDIobject *obs = table ? tableobject(table) : 0;
+    if(obs) return obs;
+
+    for(TDIobservable *o = tdiobservables; o->name; o++)
+        if(!strcmp(o->name,name))
+            return new TDIobjectpnt(this,o->obs);
+
+    return 0;
+}
+
+// user-defined combinations: one group per term, scaled by its coefficient
+
+static int validterm(const TDIterm &term) {
+    if(term.kind != 'y' && term.kind != 'z')
+        return 0;
+
+    if(term.send < 1 || term.send > 3 || term.recv < 1 || term.recv > 3 || term.send == term.recv)
+        return 0;
+
+    // the link is the arm between send and recv, in either direction
+
+    if(abs(term.link) != 6 - term.send - term.recv)
+        return 0;
+
+    for(int r=0;r<8;r++)
+        if(term.ret[r] < -3 || term.ret[r] > 3)
+            return 0;
+
+    // y takes at most seven delays, z eight
+
+    if(term.kind == 'y' && term.ret[7] != 0)
+        return 0;
+
+    return term.scale != 0.0 && finite(term.scale);
+}
+
+// the TDIobject for a table that is not built in, and that it will own;
+// classes without a typed evaluator go through the virtual y and z
+
+static TDIobject *ownedtableobject(TDI *tdi,TDItable *table) {
+    TDIobject *obs = tdi->tableobject(table,1);
+    if(!obs) obs = new TDItableobject<TDI>(tdi,table,1);
+
+    return obs;
+}
+
+TDIobject *TDI::combination(const TDIterm *theterms,int terms,LISA *geometry) {
+    if(terms < 1) {
+        std::cerr << "TDI::combination(...): need at least one term ["
+                  << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+        ExceptionUndefined e;
+        throw e;
+    }
+
+    std::vector<TDIterm> table(theterms,theterms + terms);
+
+    for(int k=0;k<terms;k++) {
+        if(!validterm(table[k])) {
+            std::cerr << "TDI::combination(...): invalid term " << k << " (" << table[k].scale << ","
+                      << table[k].kind << "," << table[k].send << "," << table[k].link << "," << table[k].recv
+                      << ") [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+            ExceptionUndefined e;
+            throw e;
+        }
+
+        table[k].block = 1;
+        table[k].sign = 1;
+    }
+
+    TDItable *compiled = new TDItable("combination",&table[0],terms);
+
+    if(geometry) {
+        TDItable *simple = simplifytable(*compiled,geometry->delaysymmetry());
+
+        delete compiled;
+        compiled = simple;
+    }
+
+    return ownedtableobject(this,compiled);
+}
+
+TDIobject *TDI::simplified(const char *name,LISA *geometry) {
+    const TDItable *table = findtditable(name);
+
+    if(!table)
+        return 0;
+
+    return ownedtableobject(this,simplifytable(*table,geometry->delaysymmetry()));
+}
+
+// fast C++ replacement for getobs and getobsc in lisautils.py
+
+static void showtime(long maxi,long maxlength,time_t begtime) {
+    double percdone = (100.0 * maxi) / maxlength;
+
+    time_t elapsed = time(NULL) - begtime;
+
+    int vel = int((1.0 * maxi) / elapsed);
+
+    int timeleft = int(((1.0 * elapsed) / maxi) * (maxlength - maxi));
+
+    int minleft = timeleft / 60;
+    int secleft = timeleft - minleft*60;
+
+    char buffer[256];
+
+    if(maxi == maxlength) {
+        sprintf(buffer,"...completed in %ld s [%d rows/s].",long(elapsed),vel);
+        fprintf(stderr,"\r%-80s\n",buffer);
+    } else {
+        sprintf(buffer,"...%ld/%ld (%.2f%%) done [%d rows/s], %dm%ds left...",maxi,maxlength,percdone,vel,minleft,secleft);
+        fprintf(stderr,"\r%-80s",buffer);
+        fflush(stderr);
+    }
+}
+
+// cooperative cancellation: cancelobs() bumps the epoch, and every run
+// that started in an earlier epoch stops at its next check
+
+static volatile long cancelepoch = 0;
+
+void cancelobs() {
+    __sync_fetch_and_add(&cancelepoch,1);
+}
+
+// set by the Python layer (see lisasim-python.h); without it, only
+// cancelobs can stop a run
+
+static int (*interrupthook)() = 0;
+
+void setinterrupthook(int (*hook)()) {
+    interrupthook = hook;
+}
+
+long obsepoch() {
+    return cancelepoch;
+}
+
+void checkinterrupt(long epoch,int python) {
+    if(cancelepoch != epoch) {
+        ExceptionCancelled e;
+        throw e;
+    }
+
+    if(python && interrupthook && interrupthook()) {
+        ExceptionKeyboardInterrupt e;
+        throw e;
+    }
+}
+
+TDIfused *fuseobservables(Signal **thesignals,int signals) {
+    std::vector<const TDItable *> tables;
+    TDIobject *first = 0;
+
+    for(int j=0;j<signals;j++) {
+        TDIobject *obs = dynamic_cast<TDIobject *>(thesignals[j]);
+
+        if(!obs || !obs->gettable() || (first && obs->gettdi() != first->gettdi()))
+            return 0;
+
+        if(!first) first = obs;
+        tables.push_back(obs->gettable());
+    }
+
+    return first ? first->fuse(tables) : 0;
+}
+
+// fill rows mini...maxi-1 (stored from buffer[0] on): a single observable
+// is evaluated with one batch call; several observables are evaluated
+// sample by sample, since they usually share noise ring buffers that would
+// go stale if one observable ran ahead of the others (and together, if
+// they are table-driven observables of the same TDI object)
+
+static void getobsbatch(double *buffer,long mini,long maxi,double stime,Signal **thesignals,int signals,double inittime,double *times) {
+    TDIfused *fused = signals > 1 ? fuseobservables(thesignals,signals) : 0;
+
+    if(fused) {
+        try {
+            for(long i=mini;i<maxi;i++)
+                fused->values(inittime + stime * i,&buffer[(i-mini)*signals]);
+        } catch (...) {
+            delete fused;
+            throw;
+        }
+
+        delete fused;
+    } else if(signals == 1) {
+        for(long i=mini;i<maxi;i++)
+            times[i-mini] = inittime + stime * i;
+
+        thesignals[0]->values(times,buffer,maxi-mini);
+    } else {
+        for(long i=mini;i<maxi;i++) {
+            double t = inittime + stime * i;
+
+            for(int j=0;j<signals;j++) {
+                buffer[(i-mini)*signals + j] = thesignals[j]->value(t);
+            }
+        }
+    }
+}
+
+// divide up the cycle into batches of 16384
+
+const int batchlen = 16384;
+
+void fastgetobsc(double *buffer,long length,long samples,double stime,Signal **thesignals,int signals,double inittime) {
+    long maxlength = length < samples ? length : samples;
+    
+    int batches = (maxlength % batchlen) == 0 ? (maxlength / batchlen) : (maxlength / batchlen + 1);
+
+    double *times = new double[batchlen];
+
+    long epoch = obsepoch();
+    time_t begtime = time(NULL);
+
+    fprintf(stderr,"Processing (running enhanced TDI C++ cycle)...");
+    fflush(stderr);
+
+    try {
+        for(int b=0;b<batches;b++) {
+            long mini = b * batchlen;
+            long maxi = (mini + batchlen) < maxlength ? (mini + batchlen) : maxlength;
+
+            getobsbatch(&buffer[mini*signals],mini,maxi,stime,thesignals,signals,inittime,times);
+
+            showtime(maxi,maxlength,begtime);
+            checkinterrupt(epoch);
+        }
+    } catch (...) {
+        delete [] times;
+        throw;
+    }
+
+    delete [] times;
+}
+
+void fastgetobs(double *buffer,long length,long samples,double stime,Signal **thesignals,int signals,double inittime) {
+    long maxlength = length < samples ? length : samples;
+
+    double *times = new double[batchlen];
+
+    long epoch = obsepoch();
+
+    try {
+        for(long mini=0;mini<maxlength;mini+=batchlen) {
+            long maxi = (mini + batchlen) < maxlength ? (mini + batchlen) : maxlength;
+
+            getobsbatch(&buffer[mini*signals],mini,maxi,stime,thesignals,signals,inittime,times);
+            checkinterrupt(epoch);
+        }
+    } catch (...) {
+        delete [] times;
+        throw;
+    }
+
+    delete [] times;
+}
+
+void fastgetobschunk(double *buffer,long length,long samples,double stime,Signal **thesignals,int signals,double inittime,long offset) {
+    long maxlength = length < samples ? length : samples;
+
+    double *times = new double[batchlen];
+
+    long epoch = obsepoch();
+
+    try {
+        for(long mini=0;mini<maxlength;mini+=batchlen) {
+            long maxi = (mini + batchlen) < maxlength ? (mini + batchlen) : maxlength;
+
+            getobsbatch(&buffer[mini*signals],offset+mini,offset+maxi,stime,thesignals,signals,inittime,times);
+            checkinterrupt(epoch);
+        }
+    } catch (...) {
+        delete [] times;
+        throw;
+    }
+
+    delete [] times;
+}
+
+// the interleaved versions divide the buffer length by the number of
+// signals, so an empty list must be caught first
+
+static void checksignals(const char *function,int signals) {
+    if(signals < 1) {
+        std::cerr << function << "(...): need at least one observable ["
+                  << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+        ExceptionUndefined e;
+        throw e;
+    }
+}
+
+void fastgetobstimes(double *buffer,long length,double *times,long samples,Signal **thesignals,int signals) {
+    checksignals("fastgetobstimes",signals);
+
+    long maxlength = length / signals < samples ? length / signals : samples;
+
+    // the buffered signal sources can only move forward
+
+    for(long i=1;i<maxlength;i++) {
+        if(times[i] < times[i-1]) {
+            std::cerr << "fastgetobstimes(...): times are not sorted at index " << i
+                      << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+            ExceptionWrongArguments e;
+            throw e;
+        }
+    }
+
+    long epoch = obsepoch();
+
+    for(long mini=0;mini<maxlength;mini+=batchlen) {
+        long maxi = (mini + batchlen) < maxlength ? (mini + batchlen) : maxlength;
+
+        if(signals == 1) {
+            thesignals[0]->values(&times[mini],&buffer[mini],maxi-mini);
+        } else {
+            for(long i=mini;i<maxi;i++)
+                for(int j=0;j<signals;j++)
+                    buffer[i*signals + j] = thesignals[j]->value(times[i]);
+        }
+
+        checkinterrupt(epoch);
+    }
+}
+
+void fastgetobsdec(double *buffer,long length,long samples,double stime,Signal **thesignals,int signals,double inittime,int decimation,double *filter,int taps) {
+    if(decimation < 1 || taps < 1) {
+        std::cerr << "fastgetobsdec(...): need decimation >= 1 and at least one filter tap ["
+                  << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+        ExceptionWrongArguments e;
+        throw e;
+    }
+
+    checksignals("fastgetobsdec",signals);
+
+    long maxlength = length / signals < samples ? length / signals : samples;
+
+    // output k uses full-rate samples k*decimation ... k*decimation + taps - 1,
+    // and is centered on sample k*decimation + half, so that no sample
+    // falls before inittime (where the noises would not yet be buffered);
+    // work holds the full-rate rows from index base on, and is refilled
+    // in batches, keeping only the rows still needed by later outputs
+
+    long half = (taps - 1) / 2;
+    long worklen = taps + batchlen;
+
+    double *work = new double[worklen * signals];
+    double *times = new double[worklen];
+
+    long base = 0, filled = 0;
+
+    // the last output needs no rows beyond this one (exclusive), so the
+    // final refill stops there rather than evaluating a full batch
+
+    long lastrow = (maxlength - 1) * decimation + taps;
+
+    long epoch = obsepoch();
+
+    try {
+        for(long k=0;k<maxlength;) {
+            long fill = worklen - filled;
+            if(base + filled + fill > lastrow) fill = lastrow - (base + filled);
+
+            getobsbatch(&work[filled*signals],base+filled,base+filled+fill,stime,thesignals,signals,inittime,times);
+            filled += fill;
+
+            // compute all the outputs whose window is complete
+
+            for(;k<maxlength && k*decimation + taps <= base + filled;k++) {
+                double *window = &work[(k*decimation - base)*signals];
+
+                for(int j=0;j<signals;j++) {
+                    double sum = 0.0;
+
+                    for(int m=0;m<taps;m++)
+                        sum += filter[m] * window[m*signals + j];
+
+                    buffer[k*signals + j] = sum;
+                }
+            }
+
+            // drop the rows that come before the next window
+
+            long drop = k*decimation - base;
+            if(drop > filled) drop = filled;
+
+            memmove(work,&work[drop*signals],(filled - drop)*signals*sizeof(double));
+
+            base += drop;
+            filled -= drop;
+
+            // with fewer taps than the decimation factor, the next window
+            // may begin beyond the rows evaluated so far: skip ahead
+
+            if(filled == 0 && k*decimation > base)
+                base = k*decimation;
+
+            checkinterrupt(epoch);
+        }
+    } catch (...) {
+        delete [] times;
+        delete [] work;
+        throw;
+    }
+
+    delete [] times;
+    delete [] work;
+}
+
+void fastgetobsf(float *buffer,long length,long samples,double stime,Signal **thesignals,int signals,double inittime,long offset,int display) {
+    checksignals("fastgetobsf",signals);
+
+    long maxlength = length / signals < samples ? length / signals : samples;
+
+    double *dbuffer = new double[batchlen * signals];
+    double *times = new double[batchlen];
+
+    long epoch = obsepoch();
+    time_t begtime = time(NULL);
+
+    if(display) {
+        fprintf(stderr,"Processing (running enhanced TDI C++ cycle)...");
+        fflush(stderr);
+    }
+
+    try {
+        for(long mini=0;mini<maxlength;mini+=batchlen) {
+            long maxi = (mini + batchlen) < maxlength ? (mini + batchlen) : maxlength;
+
+            getobsbatch(dbuffer,offset+mini,offset+maxi,stime,thesignals,signals,inittime,times);
+
+            for(long k=0;k<(maxi-mini)*signals;k++)
+                buffer[mini*signals + k] = float(dbuffer[k]);
+
+            if(display) showtime(maxi,maxlength,begtime);
+            checkinterrupt(epoch);
+        }
+    } catch (...) {
+        delete [] times;
+        delete [] dbuffer;
+        throw;
+    }
+
+    delete [] times;
+    delete [] dbuffer;
+}
+
+static void writebatch(int fd,const void *buffer,size_t bytes) {
+    const char *pnt = (const char *)buffer;
+    size_t left = bytes;
+
+    while(left > 0) {
+        ssize_t written = write(fd,pnt,left);
+
+        if(written < 0) {
+            if(errno == EINTR) continue;
+
+            std::cerr << "fastgetobsfd(...): cannot write to file (" << strerror(errno)
+                      << ") [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+            ExceptionFileError e;
+            throw e;
+        }
+
+        pnt += written;
+        left -= written;
+    }
+}
+
+// pipelined output: the compute thread fills blocks of batchlen rows, and
+// a writer thread drains them to disk, through a single-producer/single-
+// consumer ring of preallocated blocks; head is advanced only by the
+// producer and tail only by the consumer, so no locks are needed, and at
+// most pipelineblocks blocks are in flight
+
+const int pipelineblocks = 4;
+
+struct writepipe {
+    int fd;
+
+    // blocks are computed in double precision; with single output they
+    // are converted to the matching fblocks, and those are written
+
+    double *blocks[pipelineblocks];
+    float *fblocks[pipelineblocks];
+    size_t bytes[pipelineblocks];
+
+    volatile long head, tail;
+
+    // set by the producer when there are no more blocks, and by the
+    // consumer when a write fails (the error is rethrown by the producer)
+
+    volatile int done, failed;
+};
+
+// the blocks take much longer to compute than to hand over, so waiting
+// sides just nap briefly instead of spinning
+
+static void pipewait() {
+    struct timespec nap = {0, 100000};
+    nanosleep(&nap,0);
+}
+
+static const void *pipeblock(writepipe *pipe,int slot) {
+    return pipe->fblocks[slot] ? (const void *)pipe->fblocks[slot] : (const void *)pipe->blocks[slot];
+}
+
+static void *pipewriter(void *arg) {
+    writepipe *pipe = (writepipe *)arg;
+
+    for(;;) {
+        if(pipe->tail == pipe->head) {
+            if(pipe->done) {
+                // recheck, since the last block may have come in after the test above
+
+                __sync_synchronize();
+                if(pipe->tail == pipe->head) break;
+            }
+
+            pipewait();
+            continue;
+        }
+
+        // read the block only after seeing the head that published it
+
+        __sync_synchronize();
+
+        int slot = pipe->tail % pipelineblocks;
+
+        try {
+            writebatch(pipe->fd,pipeblock(pipe,slot),pipe->bytes[slot]);
+        } catch (ExceptionFileError &e) {
+            pipe->failed = 1;
+            break;
+        }
+
+        __sync_synchronize();
+        pipe->tail = pipe->tail + 1;
+    }
+
+    return 0;
+}
+
+void fastgetobsfd(int fd,long samples,double stime,Signal **thesignals,int signals,double inittime,int display,int single,long offset) {
+    double *times = new double[batchlen];
+
+    writepipe pipe;
+
+    pipe.fd = fd;
+    pipe.head = pipe.tail = 0;
+    pipe.done = pipe.failed = 0;
+
+    for(int b=0;b<pipelineblocks;b++) {
+        pipe.blocks[b] = new double[batchlen * signals];
+        pipe.fblocks[b] = single ? new float[batchlen * signals] : 0;
+    }
+
+    // if we cannot start the writer, write from this thread
+
+    pthread_t writer;
+    int threaded = (pthread_create(&writer,0,pipewriter,&pipe) == 0);
+
+    long epoch = obsepoch();
+    time_t begtime = time(NULL);
+
+    if(display) {
+        fprintf(stderr,"Processing (running enhanced TDI C++ cycle)...");
+        fflush(stderr);
+    }
 
-#include <time.h>
-#include <stdio.h>
+    try {
+        for(long mini=0;mini<samples;mini+=batchlen) {
+            long maxi = (mini + batchlen) < samples ? (mini + batchlen) : samples;
+            long values = (maxi - mini) * signals;
 
-// in these expressions the order of the delays is physically
-// motivated, but the combination still does not cancel laser
-// noise (from the final ref. lasers) in ModifiedLISA
+            // wait for a free block (or for the writer to give up)
 
-double TDI::alpham(double t) {
-    return( y(3,-2, 1, 0, 0, 0, t) -
-            y(2, 3, 1, 0, 0, 0, t) +
-            y(2,-1, 3,-2, 0, 0, t) -
-            y(3, 1, 2, 3, 0, 0, t) +
-            y(1,-3, 2,-1,-2, 0, t) -
-            y(1, 2, 3, 1, 3, 0, t) +
-    0.5 * ( z(2, 3, 1,-3,-1,-2, 0, t) -
-            z(3,-2, 1, 2, 1, 3, 0, t) +
-            z(3, 1, 2,-1,-2, 0, 0, t) -
-            z(2,-1, 3, 1, 3, 0, 0, t) +
-            z(1, 2, 3, 1, 3, 0, 0, t) -
-            z(1,-3, 2,-1,-2, 0, 0, t) +
-            z(3, 1, 2, 3, 0, 0, 0, t) -
-            z(2,-1, 3,-2, 0, 0, 0, t) +
-            z(1, 2, 3,-2, 0, 0, 0, t) -
-            z(1,-3, 2, 3, 0, 0, 0, t) +
-            z(2, 3, 1, 0, 0, 0, 0, t) -
-            z(3,-2, 1, 0, 0, 0, 0, t) ) );
-}
+            while(threaded && pipe.head - pipe.tail == pipelineblocks && !pipe.failed)
+                pipewait();
 
-double TDI::betam(double t) {
-    return( y(1,-3, 2, 0, 0, 0, t) -
-            y(3, 1, 2, 0, 0, 0, t) +
-            y(3,-2, 1,-3, 0, 0, t) -
-            y(1, 2, 3, 1, 0, 0, t) +
-            y(2,-1, 3,-2,-3, 0, t) -
-            y(2, 3, 1, 2, 1, 0, t) +
-    0.5 * ( z(3, 1, 2,-1,-2,-3, 0, t) -
-            z(1,-3, 2, 3, 2, 1, 0, t) +
-            z(1, 2, 3,-2,-3, 0, 0, t) -
-            z(3,-2, 1, 2, 1, 0, 0, t) +
-            z(2, 3, 1, 2, 1, 0, 0, t) -
-            z(2,-1, 3,-2,-3, 0, 0, t) +
-            z(1, 2, 3, 1, 0, 0, 0, t) -
-            z(3,-2, 1,-3, 0, 0, 0, t) +
-            z(2, 3, 1,-3, 0, 0, 0, t) -
-            z(2,-1, 3, 1, 0, 0, 0, t) +
-            z(3, 1, 2, 0, 0, 0, 0, t) -
-            z(1,-3, 2, 0, 0, 0, 0, t) ) );
-}
+            if(pipe.failed) {
+                ExceptionFileError e;
+                throw e;
+            }
 
-double TDI::gammam(double t) {
-    return( y(2,-1, 3, 0, 0, 0, t) -
-            y(1, 2, 3, 0, 0, 0, t) +
-            y(1,-3, 2,-1, 0, 0, t) -
-            y(2, 3, 1, 2, 0, 0, t) +
-            y(3,-2, 1,-3,-1, 0, t) -
-            y(3, 1, 2, 3, 2, 0, t) +
-    0.5 * ( z(1, 2, 3,-2,-3,-1, 0, t) -
-            z(2,-1, 3, 1, 3, 2, 0, t) +
-            z(2, 3, 1,-3,-1, 0, 0, t) -
-            z(1,-3, 2, 3, 2, 0, 0, t) +
-            z(3, 1, 2, 3, 2, 0, 0, t) -
-            z(3,-2, 1,-3,-1, 0, 0, t) +
-            z(2, 3, 1, 2, 0, 0, 0, t) -
-            z(1,-3, 2,-1, 0, 0, 0, t) +
-            z(3, 1, 2,-1, 0, 0, 0, t) -
-            z(3,-2, 1, 2, 0, 0, 0, t) +
-            z(1, 2, 3, 0, 0, 0, 0, t) -
-            z(2,-1, 3, 0, 0, 0, 0, t) ) );
-}
+            __sync_synchronize();
 
-// how to set the sign of the retardations here?
+            int slot = pipe.head % pipelineblocks;
+            double *block = pipe.blocks[slot];
 
-double TDI::zetam(double t) {
-    return( y(1,-3, 2, 2, 0, 0, t) -
-            y(1, 2, 3, 3, 0, 0, t) +
-            y(2,-1, 3, 3, 0, 0, t) -
-            y(2, 3, 1, 1, 0, 0, t) +
-            y(3,-2, 1, 1, 0, 0, t) -
-            y(3, 1, 2, 2, 0, 0, t) +
-    0.5 * (-z(2,-1, 3, 2, 1, 0, 0, t) +
-            z(1, 2, 3, 1, 2, 0, 0, t) -
-            z(3,-2, 1, 2, 3, 0, 0, t) +
-            z(2, 3, 1, 2, 3, 0, 0, t) -
-            z(1,-3, 2, 1, 3, 0, 0, t) +
-            z(3, 1, 2, 1, 3, 0, 0, t) ) +
-    0.5 * (-z(1,-3, 2, 2, 0, 0, 0, t) +
-            z(3, 1, 2, 2, 0, 0, 0, t) -
-            z(2,-1, 3, 3, 0, 0, 0, t) +
-            z(1, 2, 3, 3, 0, 0, 0, t) -
-            z(3,-2, 1, 1, 0, 0, 0, t) +
-            z(2, 3, 1, 1, 0, 0, 0, t) ) );
-}
+            getobsbatch(block,offset+mini,offset+maxi,stime,thesignals,signals,inittime,times);
 
-double TDI::alpha1(double t) {
-    return( y(1,-3, 2,-1,-2, 2, 1, 3, 0, 0, t) -
-            y(1, 2, 3, 1, 3,-3,-1,-2, 0, 0, t) +
-            y(2,-1, 3,-2, 2, 1, 3, 0, 0, 0, t) -
-            y(3, 1, 2, 3,-3,-1,-2, 0, 0, 0, t) +
-            y(3,-2, 1, 2, 1, 3, t) -
-            y(2, 3, 1,-3,-1,-2, t) + 
-            y(1, 2, 3, 1, 3, 0, t) - 
-            y(1,-3, 2,-1,-2, 0, t) +
-            y(3, 1, 2, 3, 0, 0, t) -
-            y(2,-1, 3,-2, 0, 0, t) +
-            y(2, 3, 1, 0, 0, 0, t) -
-            y(3,-2, 1, 0, 0, 0, t) +
-    0.5 * ( z(2, 3, 1,-3,-1,-2, 2, 1, 3, 0, 0, t) -
-            z(3,-2, 1, 2, 1, 3,-3,-1,-2, 0, 0, t) +
-            z(1, 2, 3, 1, 3,-3,-1,-2, 0, 0, 0, t) -
-            z(1,-3, 2,-1,-2, 2, 1, 3, 0, 0, 0, t) +
-            z(3, 1, 2,-1,-2, 2, 1, 3, 0, 0, 0, t) -
-            z(2,-1, 3, 1, 3,-3,-1,-2, 0, 0, 0, t) +
-            z(1, 2, 3,-2, 2, 1, 3, t) -
-            z(2,-1, 3,-2, 2, 1, 3, t) +
-            z(3, 1, 2, 3,-3,-1,-2, t) -
-            z(1,-3, 2, 3,-3,-1,-2, t) +
-            z(1,-3, 2,-1,-2, 0, 0, t) -
-            z(3, 1, 2,-1,-2, 0, 0, t) +
-            z(2,-1, 3, 1, 3, 0, 0, t) -
-            z(1, 2, 3, 1, 3, 0, 0, t) +
-            z(1,-3, 2, 3, 0, 0, 0, t) -
-            z(1, 2, 3,-2, 0, 0, 0, t) +
-            z(2,-1, 3,-2, 0, 0, 0, t) -
-            z(3, 1, 2, 3, 0, 0, 0, t) +
-            z(3,-2, 1, 0, 0, 0, 0, t) -
-            z(2, 3, 1, 0, 0, 0, 0, t) ) );
-}
+            if(single) {
+                float *fblock = pipe.fblocks[slot];
 
-double TDI::alpha2(double t) {
-    return( y(2,-1, 3,-2,-3, 3, 2, 1, 0, 0, t) -
-            y(2, 3, 1, 2, 1,-1,-2,-3, 0, 0, t) +
-            y(3,-2, 1,-3, 3, 2, 1, 0, 0, 0, t) -
-            y(1, 2, 3, 1,-1,-2,-3, 0, 0, 0, t) +
-            y(1,-3, 2, 3, 2, 1, t) -
-            y(3, 1, 2,-1,-2,-3, t) +
-            y(2, 3, 1, 2, 1, 0, t) -
-            y(2,-1, 3,-2,-3, 0, t) +
-            y(1, 2, 3, 1, 0, 0, t) -
-            y(3,-2, 1,-3, 0, 0, t) +
-            y(3, 1, 2, 0, 0, 0, t) -
-            y(1,-3, 2, 0, 0, 0, t) +
-    0.5 * ( z(3, 1, 2,-1,-2,-3, 3, 2, 1, 0, 0, t) -
-            z(1,-3, 2, 3, 2, 1,-1,-2,-3, 0, 0, t) +
-            z(2, 3, 1, 2, 1,-1,-2,-3, 0, 0, 0, t) -
-            z(2,-1, 3,-2,-3, 3, 2, 1, 0, 0, 0, t) +
-            z(1, 2, 3,-2,-3, 3, 2, 1, 0, 0, 0, t) -
-            z(3,-2, 1, 2, 1,-1,-2,-3, 0, 0, 0, t) +
-            z(2, 3, 1,-3, 3, 2, 1, t) -
-            z(3,-2, 1,-3, 3, 2, 1, t) +
-            z(1, 2, 3, 1,-1,-2,-3, t) -
-            z(2,-1, 3, 1,-1,-2,-3, t) +
-            z(2,-1, 3,-2,-3, 0, 0, t) -
-            z(1, 2, 3,-2,-3, 0, 0, t) +
-            z(3,-2, 1, 2, 1, 0, 0, t) -
-            z(2, 3, 1, 2, 1, 0, 0, t) +
-            z(2,-1, 3, 1, 0, 0, 0, t) -
-            z(2, 3, 1,-3, 0, 0, 0, t) +
-            z(3,-2, 1,-3, 0, 0, 0, t) -
-            z(1, 2, 3, 1, 0, 0, 0, t) +
-            z(1,-3, 2, 0, 0, 0, 0, t) -
-            z(3, 1, 2, 0, 0, 0, 0, t) ) );
-}
+                for(long k=0;k<values;k++)
+                    fblock[k] = float(block[k]);
 
-double TDI::alpha3(double t) {
-    return( y(3,-2, 1,-3,-1, 1, 3, 2, 0, 0, t) -
-            y(3, 1, 2, 3, 2,-2,-3,-1, 0, 0, t) + 
-            y(1,-3, 2,-1, 1, 3, 2, 0, 0, 0, t) -
-            y(2, 3, 1, 2,-2,-3,-1, 0, 0, 0, t) +
-            y(2,-1, 3, 1, 3, 2, t) -
-            y(1, 2, 3,-2,-3,-1, t) +
-            y(3, 1, 2, 3, 2, 0, t) -
-            y(3,-2, 1,-3,-1, 0, t) +
-            y(2, 3, 1, 2, 0, 0, t) -
-            y(1,-3, 2,-1, 0, 0, t) +
-            y(1, 2, 3, 0, 0, 0, t) -
-            y(2,-1, 3, 0, 0, 0, t) +
-    0.5 * ( z(1, 2, 3,-2,-3,-1, 1, 3, 2, 0, 0, t) -
-            z(2,-1, 3, 1, 3, 2,-2,-3,-1, 0, 0, t) +
-            z(3, 1, 2, 3, 2,-2,-3,-1, 0, 0, 0, t) -
-            z(3,-2, 1,-3,-1, 1, 3, 2, 0, 0, 0, t) +
-            z(2, 3, 1,-3,-1, 1, 3, 2, 0, 0, 0, t) -
-            z(1,-3, 2, 3, 2,-2,-3,-1, 0, 0, 0, t) +
-            z(3, 1, 2,-1, 1, 3, 2, t) -
-            z(1,-3, 2,-1, 1, 3, 2, t) +
-            z(2, 3, 1, 2,-2,-3,-1, t) -
-            z(3,-2, 1, 2,-2,-3,-1, t) +
-            z(3,-2, 1,-3,-1, 0, 0, t) -
-            z(2, 3, 1,-3,-1, 0, 0, t) +
-            z(1,-3, 2, 3, 2, 0, 0, t) -
-            z(3, 1, 2, 3, 2, 0, 0, t) +
-            z(3,-2, 1, 2, 0, 0, 0, t) -
-            z(3, 1, 2,-1, 0, 0, 0, t) +
-            z(1,-3, 2,-1, 0, 0, 0, t) -
-            z(2, 3, 1, 2, 0, 0, 0, t) +
-            z(2,-1, 3, 0, 0, 0, 0, t) -
-            z(1, 2, 3, 0, 0, 0, 0, t) ) );
-}
+                pipe.bytes[slot] = values * sizeof(float);
+            } else {
+                pipe.bytes[slot] = values * sizeof(double);
+            }
 
-double TDI::zeta1(double t) {
-    return( ( y(3,-2, 1, 1, 2, 3, t) -
-              y(3, 1, 2,-2, 2, 3, t) +
-              y(1,-3, 2,-2, 2, 3, t) ) -
-            ( y(1, 2, 3, 3,-3,-2, t) -
-              y(2,-1, 3, 3,-3,-2, t) +
-              y(2, 3, 1,-1,-3,-2, t) ) -
-            ( y(3,-2, 1, 1,-1, 0, t) -
-              y(3, 1, 2,-2,-1, 0, t) +
-              y(1,-3, 2,-2,-1, 0, t) ) +
-            ( y(1, 2, 3, 3, 1, 0, t) -
-              y(2,-1, 3, 3, 1, 0, t) +
-              y(2, 3, 1,-1, 1, 0, t) ) +
-      0.5*( ( z(3, 1, 2,-2, 2, 3, 0, t) -
-              z(1,-3, 2,-2, 2, 3, 0, t)   ) -
-            ( z(3, 1, 2,-2,-1, 0, 0, t) -
-              z(1,-3, 2,-2,-1, 0, 0, t)   ) +
-            ( z(3, 1, 2,-1, 3,-3,-2, t) -
-              z(1,-3, 2,-1, 3,-3,-2, t)   ) -
-            ( z(3, 1, 2,-1, 3, 1, 0, t) -
-              z(1,-3, 2,-1, 3, 1, 0, t)   ) +
-            ( z(1, 2, 3,-2, 2, 3, 1, t) -
-              z(2,-1, 3,-2, 2, 3, 1, t)   ) -
-            ( z(1, 2, 3,-2,-1, 1, 0, t) -
-              z(2,-1, 3,-2,-1, 1, 0, t)   ) +
-            ( z(1, 2, 3,-2,-3, 3, 0, t) -
-              z(2,-1, 3,-2,-3, 3, 0, t)   ) -
-            ( z(1, 2, 3, 3, 1, 0, 0, t) -
-              z(2,-1, 3, 3, 1, 0, 0, t)   ) +
-            ( z(2, 3, 1,-2, 2,-3, 3, t) -
-              z(3,-2, 1,-2, 2,-3, 3, t)   ) -
-            ( z(2, 3, 1,-1, 1, 0, 0, t) -
-              z(3,-2, 1,-1, 1, 0, 0, t)   ) ) );
-}
+            // publish the block only after it is complete
 
-double TDI::zeta2(double t) {
-    return( ( y(1,-3, 2, 2, 3, 1, t) -
-              y(1, 2, 3,-3, 3, 1, t) +
-              y(2,-1, 3,-3, 3, 1, t) ) -
-            ( y(2, 3, 1, 1,-1,-3, t) -
-              y(3,-2, 1, 1,-1,-3, t) +
-              y(3, 1, 2,-2,-1,-3, t) ) -
-            ( y(1,-3, 2, 2,-2, 0, t) -
-              y(1, 2, 3,-3,-2, 0, t) +
-              y(2,-1, 3,-3,-2, 0, t) ) +
-            ( y(2, 3, 1, 1, 2, 0, t) -
-              y(3,-2, 1, 1, 2, 0, t) +
-              y(3, 1, 2,-2, 2, 0, t) ) +
-      0.5*( ( z(1, 2, 3,-3, 3, 1, 0, t) -
-              z(2,-1, 3,-3, 3, 1, 0, t)   ) -
-            ( z(1, 2, 3,-3,-2, 0, 0, t) -
-              z(2,-1, 3,-3,-2, 0, 0, t)   ) +
-            ( z(1, 2, 3,-2, 1,-1,-3, t) -
-              z(2,-1, 3,-2, 1,-1,-3, t)   ) -
-            ( z(1, 2, 3,-2, 1, 2, 0, t) -
-              z(2,-1, 3,-2, 1, 2, 0, t)   ) +
-            ( z(2, 3, 1,-3, 3, 1, 2, t) -
-              z(3,-2, 1,-3, 3, 1, 2, t)   ) -
-            ( z(2, 3, 1,-3,-2, 2, 0, t) -
-              z(3,-2, 1,-3,-2, 2, 0, t)   ) +
-            ( z(2, 3, 1,-3,-1, 1, 0, t) -
-              z(3,-2, 1,-3,-1, 1, 0, t)   ) -
-            ( z(2, 3, 1, 1, 2, 0, 0, t) -
-              z(3,-2, 1, 1, 2, 0, 0, t)   ) +
-            ( z(3, 1, 2,-3, 3,-1, 1, t) -
-              z(1,-3, 2,-3, 3,-1, 1, t)   ) -
-            ( z(3, 1, 2,-2, 2, 0, 0, t) -
-              z(1,-3, 2,-2, 2, 0, 0, t)   ) ) );
-}
+            if(threaded) {
+                __sync_synchronize();
+                pipe.head = pipe.head + 1;
+            } else {
+                writebatch(fd,pipeblock(&pipe,slot),pipe.bytes[slot]);
+            }
 
-double TDI::zeta3(double t) {
-    return( ( y(2,-1, 3, 3, 1, 2, t) -
-              y(2, 3, 1,-1, 1, 2, t) +
-              y(3,-2, 1,-1, 1, 2, t) ) -
-            ( y(3, 1, 2, 2,-2,-1, t) -
-              y(1,-3, 2, 2,-2,-1, t) +
-              y(1, 2, 3,-3,-2,-1, t) ) -
-            ( y(2,-1, 3, 3,-3, 0, t) -
-              y(2, 3, 1,-1,-3, 0, t) +
-              y(3,-2, 1,-1,-3, 0, t) ) +
-            ( y(3, 1, 2, 2, 3, 0, t) -
-              y(1,-3, 2, 2, 3, 0, t) +
-              y(1, 2, 3,-3, 3, 0, t) ) +
-      0.5*( ( z(2, 3, 1,-1, 1, 2, 0, t) -
-              z(3,-2, 1,-1, 1, 2, 0, t)   ) -
-            ( z(2, 3, 1,-1,-3, 0, 0, t) -
-              z(3,-2, 1,-1,-3, 0, 0, t)   ) +
-            ( z(2, 3, 1,-3, 2,-2,-1, t) -
-              z(3,-2, 1,-3, 2,-2,-1, t)   ) -
-            ( z(2, 3, 1,-3, 2, 3, 0, t) -
-              z(3,-2, 1,-3, 2, 3, 0, t)   ) +
-            ( z(3, 1, 2,-1, 1, 2, 3, t) -
-              z(1,-3, 2,-1, 1, 2, 3, t)   ) -
-            ( z(3, 1, 2,-1,-3, 3, 0, t) -
-              z(1,-3, 2,-1,-3, 3, 0, t)   ) +
-            ( z(3, 1, 2,-1,-2, 2, 0, t) -
-              z(1,-3, 2,-1,-2, 2, 0, t)   ) -
-            ( z(3, 1, 2, 2, 3, 0, 0, t) -
-              z(1,-3, 2, 2, 3, 0, 0, t)   ) +
-            ( z(1, 2, 3,-1, 1,-2, 2, t) -
-              z(2,-1, 3,-1, 1,-2, 2, t)   ) -
-            ( z(1, 2, 3,-3, 3, 0, 0, t) -
-              z(2,-1, 3,-3, 3, 0, 0, t)   ) ) );
-}
+            if(display) showtime(maxi,samples,begtime);
+            checkinterrupt(epoch);
+        }
+    } catch (...) {
+        // let the writer finish the blocks computed so far, as the
+        // unpipelined loop would have written them
 
-// to be updated with physical-delay expressions
-// and with multiple arm expressions
+        __sync_synchronize();
+        pipe.done = 1;
+        if(threaded) pthread_join(writer,0);
 
-double TDI::P(double t) {
-    return( y(1, 3, 2, 2, 0, 0, t) -
-            y(1, 2, 3, 3, 0, 0, t) - 
-            y(3, 1, 2, 2, 0, 0, t) +
-            y(2, 1, 3, 3, 0, 0, t) +
-            y(3, 1, 2, 1, 3, 0, t) -
-            y(2, 1, 3, 1, 2, 0, t) + 
-            y(1, 2, 3, 3, 1, 1, t) -
-            y(1, 3, 2, 2, 1, 1, t) +
-    0.5 * (-z(3, 2, 1, 2, 3, 0, 0, t) +
-            z(3, 2, 1, 1, 1, 2, 3, t) + 
-            z(2, 3, 1, 2, 3, 0, 0, t) -
-            z(2, 3, 1, 1, 1, 2, 3, t) ) +
-    0.5 * (-z(1, 3, 2, 2, 0, 0, 0, t) + 
-            z(1, 3, 2, 1, 1, 2, 0, t) +
-            z(3, 1, 2, 2, 0, 0, 0, t) -
-            z(3, 1, 2, 1, 1, 2, 0, t) ) +
-    0.5 * (-z(2, 1, 3, 3, 0, 0, 0, t) +
-            z(2, 1, 3, 1, 1, 3, 0, t) +
-            z(1, 2, 3, 3, 0, 0, 0, t) -
-            z(1, 2, 3, 1, 1, 3, 0, t) ) );
-}
+        for(int b=0;b<pipelineblocks;b++) {
+            delete [] pipe.fblocks[b];
+            delete [] pipe.blocks[b];
+        }
 
-double TDI::E(double t) {
-    return( y(3, 1, 2, 2, 1, 0, t) -
-            y(2, 1, 3, 3, 1, 0, t) -
-            y(3, 1, 2, 3, 0, 0, t) +
-            y(2, 1, 3, 2, 0, 0, t) +
-            y(2, 3, 1, 1, 1, 0, t) -
-            y(3, 2, 1, 1, 1, 0, t) -
-            y(2, 3, 1, 0, 0, 0, t) +
-            y(3, 2, 1, 0, 0, 0, t) -
-    0.5 * ( z(2, 1, 3, 2, 0, 0, 0, t) +
-            z(3, 2, 1, 0, 0, 0, 0, t) +
-            z(1, 3, 2, 3, 0, 0, 0, t) -
-            z(2, 1, 3, 1, 1, 2, 0, t) +
-            z(1, 2, 3, 1, 1, 2, 0, t) -
-            z(1, 3, 2, 1, 1, 3, 0, t) ) +
-    0.5 * ( z(1, 2, 3, 2, 0, 0, 0, t) +
-            z(2, 3, 1, 0, 0, 0, 0, t) +
-            z(3, 1, 2, 3, 0, 0, 0, t) -
-            z(3, 1, 2, 1, 1, 3, 0, t) +
-            z(3, 2, 1, 1, 1, 0, 0, t) -
-            z(2, 3, 1, 1, 1, 0, 0, t) ) );
-};
+        delete [] times;
+        throw;
+    }
 
-double TDI::U(double t) {
-    return( y(3, 2, 1, 1, 1, 3, t) -
-            y(3, 2, 1, 3, 0, 0, t) -
-            y(3, 1, 2, 1, 2, 3, t) +
-            y(2, 1, 3, 1, 0, 0, t) -
-            y(2, 1, 3, 2, 3, 0, t) +
-            y(1, 3, 2, 1, 1, 0, t) -
-            y(1, 3, 2, 0, 0, 0, t) +
-            y(3, 1, 2, 0, 0, 0, t) -
-    0.5 * ( z(2, 3, 1, 3, 0, 0, 0, t) +
-            z(3, 1, 2, 0, 0, 0, 0, t) +
-            z(1, 2, 3, 2, 3, 0, 0, t) +
-            z(1, 3, 2, 1, 1, 0, 0, t) +
-            z(2, 1, 3, 1, 1, 2, 3, t) +
-            z(3, 2, 1, 1, 1, 3, 0, t) ) +
-    0.5 * ( z(3, 2, 1, 3, 0, 0, 0, t) +
-            z(1, 3, 2, 0, 0, 0, 0, t) +
-            z(2, 1, 3, 2, 3, 0, 0, t) +
-            z(3, 1, 2, 1, 1, 0, 0, t) +
-            z(1, 2, 3, 1, 1, 2, 3, t) +
-            z(2, 3, 1, 1, 1, 3, 0, t) ) );
-};
+    __sync_synchronize();
+    pipe.done = 1;
+    if(threaded) pthread_join(writer,0);
 
-double TDI::Xm(double t) {
-    return( y(1,-3, 2, 3, 2,-2, t) -
-            y(1, 2, 3,-2,-3, 3, t) +
-            y(2, 3, 1, 2,-2, 0, t) -
-            y(3,-2, 1,-3, 3, 0, t) +
-            y(1, 2, 3,-2, 0, 0, t) -
-            y(1,-3, 2, 3, 0, 0, t) + 
-            y(3,-2, 1, 0, 0, 0, t) -
-            y(2, 3, 1, 0, 0, 0, t) +
-    0.5 * (-z(3,-2, 1, 2,-2,-3, 3, t) +
-            z(3,-2, 1,-3, 3, 0, 0, t) +
-            z(3,-2, 1, 2,-2, 0, 0, t) -
-            z(3,-2, 1, 0, 0, 0, 0, t) ) +
-    0.5 * ( z(2, 3, 1,-3, 3, 2,-2, t) -
-            z(2, 3, 1,-3, 3, 0, 0, t) -
-            z(2, 3, 1, 2,-2, 0, 0, t) +
-            z(2, 3, 1, 0, 0, 0, 0, t) ) );
-}
+    for(int b=0;b<pipelineblocks;b++) {
+        delete [] pipe.fblocks[b];
+        delete [] pipe.blocks[b];
+    }
 
-double TDI::Xmlock1(double t) {
-    return( y(2, 3, 1, 2,-2, 0, t) -
-            y(3,-2, 1,-3, 3, 0, t) +
-            y(3,-2, 1, 0, 0, 0, t) -
-            y(2, 3, 1, 0, 0, 0, t) );
-}
+    delete [] times;
 
-double TDI::Xmlock2(double t) {
-    return( y(1,-3, 2, 3, 2,-2, t) -
-            y(1, 2, 3,-2,-3, 3, t) -
-            y(3,-2, 1,-3, 3, 0, t) +
-            y(1, 2, 3,-2, 0, 0, t) -
-            y(1,-3, 2, 3, 0, 0, t) + 
-            y(3,-2, 1, 0, 0, 0, t) );
+    if(pipe.failed) {
+        ExceptionFileError e;
+        throw e;
+    }
 }
 
-double TDI::Xmlock3(double t) {
-    return( y(1,-3, 2, 3, 2,-2, t) -
-            y(1, 2, 3,-2,-3, 3, t) +
-            y(2, 3, 1, 2,-2, 0, t) +
-            y(1, 2, 3,-2, 0, 0, t) -
-            y(1,-3, 2, 3, 0, 0, t) -
-            y(2, 3, 1, 0, 0, 0, t) );
-}
+void fastgetobsfile(const char *filename,long samples,double stime,Signal **thesignals,int signals,double inittime,int display,int append,int single,long offset) {
+    int fd = open(filename,O_WRONLY | O_CREAT | (append ? O_APPEND : O_TRUNC),0644);
 
-double TDI::Ym(double t) {
-    return( y(2,-1, 3, 1, 3,-3, t)
-           -y(2, 3, 1,-3,-1, 1, t)
-           +y(3, 1, 2, 3,-3, 0, t)
-           -y(1,-3, 2,-1, 1, 0, t)
-           +y(2, 3, 1,-3, 0, 0, t)
-           -y(2,-1, 3, 1, 0, 0, t)
-           +y(1,-3, 2, 0, 0, 0, t)
-           -y(3, 1, 2, 0, 0, 0, t) +
-    0.5 * ( z(3, 1, 2,-1, 1, 3,-3, t)
-           -z(3, 1, 2,-1, 1, 0, 0, t)
-           -z(3, 1, 2, 3,-3, 0, 0, t)
-           +z(3, 1, 2, 0, 0, 0, 0, t) ) +
-    0.5 * (-z(1,-3, 2, 3,-3,-1, 1, t)
-           +z(1,-3, 2,-1, 1, 0, 0, t)
-           +z(1,-3, 2, 3,-3, 0, 0, t)
-           -z(1,-3, 2, 0, 0, 0, 0, t) ) );
-}
+    if(fd < 0) {
+        std::cerr << "fastgetobsfile(...): cannot open file " << filename
+                  << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
 
-double TDI::Zm(double t) {
-    return( y(3,-2, 1, 2, 1,-1, t)
-           -y(3, 1, 2,-1,-2, 2, t)
-           +y(1, 2, 3, 1,-1, 0, t)
-           -y(2,-1, 3,-2, 2, 0, t)
-           +y(3, 1, 2,-1, 0, 0, t)
-           -y(3,-2, 1, 2, 0, 0, t)
-           +y(2,-1, 3, 0, 0, 0, t) 
-           -y(1, 2, 3, 0, 0, 0, t) +
-    0.5 * (-z(2,-1, 3, 1,-1,-2, 2, t)
-           +z(2,-1, 3, 1,-1, 0, 0, t)
-           +z(2,-1, 3,-2, 2, 0, 0, t)
-           -z(2,-1, 3, 0, 0, 0, 0, t) ) +
-    0.5 * ( z(1, 2, 3,-2, 2, 1,-1, t)
-           -z(1, 2, 3,-2, 2, 0, 0, t)
-           -z(1, 2, 3, 1,-1, 0, 0, t)
-           +z(1, 2, 3, 0, 0, 0, 0, t) ) );
-}
+        ExceptionFileError e;
+        throw e;
+    }
 
-double TDI::X1(double t) {
-    return( y(1,-3, 2, 3, 2,-2, 2,-2,-3, 3, t) 
-	   -y(1, 2, 3,-2,-3, 3,-3, 3, 2,-2, t) 
-	   +y(2, 3, 1, 2,-2, 2,-2,-3, 3, 0, t) 
-	   -y(3,-2, 1,-3, 3,-3, 3, 2,-2, 0, t) 
-	   +y(1, 2, 3,-2, 2,-2,-3, 3, 0, 0, t) 
-	   -y(1,-3, 2, 3,-3, 3, 2,-2, 0, 0, t) 
-	   +y(3,-2, 1, 2,-2,-3, 3, 0, 0, 0, t)
-	   -y(2, 3, 1,-3, 3, 2,-2, 0, 0, 0, t) 
-	   +y(1, 2, 3,-2,-3, 3, t) 
-	   -y(1,-3, 2, 3, 2,-2, t) 
-	   +y(3,-2, 1,-3, 3, 0, t) 
-	   -y(2, 3, 1, 2,-2, 0, t) 
-	   +y(1,-3, 2, 3, 0, 0, t) 
-	   -y(1, 2, 3,-2, 0, 0, t) 
-	   +y(2, 3, 1, 0, 0, 0, t) 
-	   -y(3,-2, 1, 0, 0, 0, t) +
-    0.5 * ( z(2, 3, 1,-3, 3, 2,-2, 2,-2,-3, 3, t)
-	   -z(2, 3, 1,-3, 3,-3, 3, 2,-2, 0, 0, t)
-	   -z(2, 3, 1, 2,-2, 2,-2,-3, 3, 0, 0, t)
-	   +z(2, 3, 1,-3, 3, 0, 0, t)
-	   +z(2, 3, 1, 2,-2, 0, 0, t)
-	   -z(2, 3, 1, 0, 0, 0, 0, t) ) +
-    0.5 * (-z(3,-2, 1, 2,-2,-3, 3,-3, 3, 2,-2, t)
-	   +z(3,-2, 1,-3, 3,-3, 3, 2,-2, 0, 0, t)
-	   +z(3,-2, 1, 2,-2, 2,-2,-3, 3, 0, 0, t)
-	   -z(3,-2, 1,-3, 3, 0, 0, t)
-	   -z(3,-2, 1, 2,-2, 0, 0, t)
-	   +z(3,-2, 1, 0, 0, 0, 0, t) ) );
-}
+    try {
+        fastgetobsfd(fd,samples,stime,thesignals,signals,inittime,display,single,offset);
+    } catch (...) {
+        close(fd);
+        throw;
+    }
 
-double TDI::X2(double t) {
-    return( y(2,-1, 3, 1, 3,-3, 3,-3,-1, 1, t) 
-	   -y(2, 3, 1,-3,-1, 1,-1, 1, 3,-3, t) 
-	   +y(3, 1, 2, 3,-3, 3,-3,-1, 1, 0, t) 
-	   -y(1,-3, 2,-1, 1,-1, 1, 3,-3, 0, t) 
-	   +y(2, 3, 1,-3, 3,-3,-1, 1, 0, 0, t) 
-	   -y(2,-1, 3, 1,-1, 1, 3,-3, 0, 0, t) 
-	   +y(1,-3, 2, 3,-3,-1, 1, 0, 0, 0, t)
-	   -y(3, 1, 2,-1, 1, 3,-3, 0, 0, 0, t) 
-	   +y(2, 3, 1,-3,-1, 1, t) 
-	   -y(2,-1, 3, 1, 3,-3, t) 
-	   +y(1,-3, 2,-1, 1, 0, t) 
-	   -y(3, 1, 2, 3,-3, 0, t) 
-	   +y(2,-1, 3, 1, 0, 0, t) 
-	   -y(2, 3, 1,-3, 0, 0, t) 
-	   +y(3, 1, 2, 0, 0, 0, t) 
-	   -y(1,-3, 2, 0, 0, 0, t) +
-    0.5 * ( z(3, 1, 2,-1, 1, 3,-3, 3,-3,-1, 1, t)
-	   -z(3, 1, 2,-1, 1,-1, 1, 3,-3, 0, 0, t)
-	   -z(3, 1, 2, 3,-3, 3,-3,-1, 1, 0, 0, t)
-	   +z(3, 1, 2,-1, 1, 0, 0, t)
-	   +z(3, 1, 2, 3,-3, 0, 0, t)
-	   -z(3, 1, 2, 0, 0, 0, 0, t) ) +
-    0.5 * (-z(1,-3, 2, 3,-3,-1, 1,-1, 1, 3,-3, t)
-	   +z(1,-3, 2,-1, 1,-1, 1, 3,-3, 0, 0, t)
-	   +z(1,-3, 2, 3,-3, 3,-3,-1, 1, 0, 0, t)
-	   -z(1,-3, 2,-1, 1, 0, 0, t)
-	   -z(1,-3, 2, 3,-3, 0, 0, t)
-	   +z(1,-3, 2, 0, 0, 0, 0, t) ) );
-}
+    if(close(fd) != 0) {
+        std::cerr << "fastgetobsfile(...): error closing file " << filename
+                  << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
 
-double TDI::X3(double t) {
-    return( y(3,-2, 1, 2, 1,-1, 1,-1,-2, 2, t) 
-	   -y(3, 1, 2,-1,-2, 2,-2, 2, 1,-1, t) 
-	   +y(1, 2, 3, 1,-1, 1,-1,-2, 2, 0, t) 
-	   -y(2,-1, 3,-2, 2,-2, 2, 1,-1, 0, t) 
-	   +y(3, 1, 2,-1, 1,-1,-2, 2, 0, 0, t) 
-	   -y(3,-2, 1, 2,-2, 2, 1,-1, 0, 0, t) 
-	   +y(2,-1, 3, 1,-1,-2, 2, 0, 0, 0, t)
-	   -y(1, 2, 3,-2, 2, 1,-1, 0, 0, 0, t) 
-	   +y(3, 1, 2,-1,-2, 2, t) 
-	   -y(3,-2, 1, 2, 1,-1, t) 
-	   +y(2,-1, 3,-2, 2, 0, t) 
-	   -y(1, 2, 3, 1,-1, 0, t) 
-	   +y(3,-2, 1, 2, 0, 0, t) 
-	   -y(3, 1, 2,-1, 0, 0, t) 
-	   +y(1, 2, 3, 0, 0, 0, t) 
-	   -y(2,-1, 3, 0, 0, 0, t) +
-    0.5 * ( z(1, 2, 3,-2, 2, 1,-1, 1,-1,-2, 2, t)
-	   -z(1, 2, 3,-2, 2,-2, 2, 1,-1, 0, 0, t)
-	   -z(1, 2, 3, 1,-1, 1,-1,-2, 2, 0, 0, t)
-	   +z(1, 2, 3,-2, 2, 0, 0, t)
-	   +z(1, 2, 3, 1,-1, 0, 0, t)
-	   -z(1, 2, 3, 0, 0, 0, 0, t) ) +
-    0.5 * (-z(2,-1, 3, 1,-1,-2, 2,-2, 2, 1,-1, t)
-	   +z(2,-1, 3,-2, 2,-2, 2, 1,-1, 0, 0, t)
-	   +z(2,-1, 3, 1,-1, 1,-1,-2, 2, 0, 0, t)
-	   -z(2,-1, 3,-2, 2, 0, 0, t)
-	   -z(2,-1, 3, 1,-1, 0, 0, t)
-	   +z(2,-1, 3, 0, 0, 0, 0, t) ) );
+        ExceptionFileError e;
+        throw e;
+    }
 }
 
-// fast C++ replacement for getobs and getobsc in lisautils.py
+// --- checkpoints ---
 
-static void showtime(long maxi,long maxlength,time_t begtime) {
-    double percdone = (100.0 * maxi) / maxlength;
+static const char checkmagic[8] = {'S','L','C','H','E','C','K','1'};
 
-    time_t elapsed = time(NULL) - begtime;
+void savecheckpoint(const char *filename,TDI *tdi,long offset) {
+    std::string tmpname = std::string(filename) + ".tmp";
 
-    int vel = int((1.0 * maxi) / elapsed);
+    FILE *file = fopen(tmpname.c_str(),"wb");
 
-    int timeleft = int(((1.0 * elapsed) / maxi) * (maxlength - maxi));
+    if(file == 0) {
+        std::cerr << "savecheckpoint(...): cannot open file " << tmpname
+                  << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
 
-    int minleft = timeleft / 60;
-    int secleft = timeleft - minleft*60;
+        ExceptionFileError e;
+        throw e;
+    }
 
-    char buffer[256];
+    try {
+        savebytes(file,checkmagic,sizeof(checkmagic));
+        savebytes(file,&offset,sizeof(long));
 
-    if(maxi == maxlength) {
-        sprintf(buffer,"...completed in %ld s [%d rows/s].",long(elapsed),vel);
-        fprintf(stderr,"\r%-80s\n",buffer);
-    } else {
-        sprintf(buffer,"...%ld/%ld (%.2f%%) done [%d rows/s], %dm%ds left...",maxi,maxlength,percdone,vel,minleft,secleft);
-        fprintf(stderr,"\r%-80s",buffer);
-        fflush(stderr);
+        tdi->savestate(file);
+    } catch (...) {
+        fclose(file);
+        remove(tmpname.c_str());
+        throw;
     }
-    
-    if(PyErr_CheckSignals() != 0) {
-		ExceptionKeyboardInterrupt e;
 
-		throw e;
+    // replace the old checkpoint only when the new one is complete
+
+    if(fclose(file) != 0 || rename(tmpname.c_str(),filename) != 0) {
+        std::cerr << "savecheckpoint(...): cannot write file " << filename
+                  << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+        remove(tmpname.c_str());
+
+        ExceptionFileError e;
+        throw e;
     }
 }
 
-void fastgetobsc(double *buffer,long length,long samples,double stime,Signal **thesignals,int signals,double inittime) {
-    long maxlength = length < samples ? length : samples;
+long loadcheckpoint(const char *filename,TDI *tdi) {
+    FILE *file = fopen(filename,"rb");
 
-    // divide up the cycle into batches of 16384
-    const int batchlen = 16384;
-    
-    int batches = (maxlength % batchlen) == 0 ? (maxlength / batchlen) : (maxlength / batchlen + 1);
+    if(file == 0) {
+        std::cerr << "loadcheckpoint(...): cannot open file " << filename
+                  << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
 
-    time_t begtime = time(NULL);
+        ExceptionFileError e;
+        throw e;
+    }
 
-    fprintf(stderr,"Processing (running enhanced TDI C++ cycle)...");
-    fflush(stderr);
+    long offset;
 
-    for(int b=0;b<batches;b++) {
-        long mini = b * batchlen;
-        long maxi = (mini + batchlen) < maxlength ? (mini + batchlen) : maxlength;
+    try {
+        char magic[sizeof(checkmagic)];
 
-        for(long i=mini;i<maxi;i++) {
-            double t = inittime + stime * i;
+        loadbytes(file,magic,sizeof(checkmagic));
 
-            for(int j=0;j<signals;j++) {
-                buffer[i*signals + j] = thesignals[j]->value(t);
-            }
+        if(memcmp(magic,checkmagic,sizeof(checkmagic)) != 0) {
+            std::cerr << "loadcheckpoint(...): " << filename << " is not a checkpoint file ["
+                      << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+            ExceptionFileError e;
+            throw e;
         }
 
-        showtime(maxi,maxlength,begtime);
-    }
-}
+        loadbytes(file,&offset,sizeof(long));
 
-void fastgetobs(double *buffer,long length,long samples,double stime,Signal **thesignals,int signals,double inittime) {
-    long maxlength = length < samples ? length : samples;
+        tdi->loadstate(file);
 
-    for(int i=0;i<maxlength;i++) {
-        double t = inittime + stime * i;
-    
-        for(int j=0;j<signals;j++) {
-            buffer[i*signals + j] = thesignals[j]->value(t);
+        // the whole file should have been used
+
+        if(fgetc(file) != EOF) {
+            std::cerr << "loadcheckpoint(...): checkpoint " << filename
+                      << " does not match the TDI object [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+            ExceptionFileError e;
+            throw e;
         }
+    } catch (...) {
+        fclose(file);
+        throw;
     }
+
+    fclose(file);
+
+    return offset;
 }
 
 SampledTDI::SampledTDI(LISA *l,Noise *yijk[6],Noise *zijk[6]) {
@@ -662,6 +1722,58 @@ void SampledTDI::reset(unsigned long seed) {
     }
 }
 
+void SampledTDI::savestate(FILE *file) {
+    lisa->savestate(file);
+
+    for(int craft1 = 1; craft1 <= 3; craft1++) {
+        for(int craft2 = 1; craft2 <= 3; craft2++) {
+            if(craft1 != craft2) {
+                yobj[craft1][craft2]->savestate(file);
+                zobj[craft1][craft2]->savestate(file);
+            }
+        }
+    }
+}
+
+void SampledTDI::loadstate(FILE *file) {
+    lisa->loadstate(file);
+
+    for(int craft1 = 1; craft1 <= 3; craft1++) {
+        for(int craft2 = 1; craft2 <= 3; craft2++) {
+            if(craft1 != craft2) {
+                yobj[craft1][craft2]->loadstate(file);
+                zobj[craft1][craft2]->loadstate(file);
+            }
+        }
+    }
+}
+
+void SampledTDI::addcounters(EventCounters &counters) {
+    lisa->getcounters(counters);
+
+    for(int craft1 = 1; craft1 <= 3; craft1++) {
+        for(int craft2 = 1; craft2 <= 3; craft2++) {
+            if(craft1 != craft2) {
+                yobj[craft1][craft2]->getcounters(counters);
+                zobj[craft1][craft2]->getcounters(counters);
+            }
+        }
+    }
+}
+
+void SampledTDI::resetcounters() {
+    lisa->resetcounters();
+
+    for(int craft1 = 1; craft1 <= 3; craft1++) {
+        for(int craft2 = 1; craft2 <= 3; craft2++) {
+            if(craft1 != craft2) {
+                yobj[craft1][craft2]->resetcounters();
+                zobj[craft1][craft2]->resetcounters();
+            }
+        }
+    }
+}
+
 double SampledTDI::y(int send, int slink, int recv, int ret1, int ret2, int ret3, double t) {
     return y(send,slink,recv,ret1,ret2,ret3,0,0,0,0,t);
 }
@@ -746,3 +1858,285 @@ double SampledTDIaccurate::z(int send, int slink, int recv, int ret1, int ret2,
 
     return zobj[send][recv]->value(t,-lisa->retardation());
 }
+
+// --- TwoStageTDI ---
+
+TwoStageTDI::TwoStageTDI(LISA *l,TDI *tdi,long len,double dt,int interplen)
+    : lisa(l), basetdi(tdi), samples(12*len), length(len), current(-1), deltat(dt), semiwindow(interplen) {
+    if(interplen < 1) {
+        std::cerr << "TwoStageTDI::TwoStageTDI(...): undefined interpolator length "
+                  << interplen << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+        ExceptionUndefined e;
+        throw e;
+    }
+
+    // the streams start early enough for the longest delay chain (eight
+    // armlengths, as for the standard noises) and the filter window, so
+    // that the observables can be evaluated from t = 0
+
+    prebuffer = 8.0 * lighttime(lisa) + interplen * deltat;
+
+    // the links, one per (send,recv) pair
+
+    links[0] = tdi->y123(); links[1] = tdi->y231(); links[2] = tdi->y312();
+    links[3] = tdi->y321(); links[4] = tdi->y132(); links[5] = tdi->y213();
+
+    links[6] = tdi->z123(); links[7] = tdi->z231(); links[8] = tdi->z312();
+    links[9] = tdi->z321(); links[10] = tdi->z132(); links[11] = tdi->z213();
+
+    linkindex[1][3] = 0; linkindex[2][1] = 1; linkindex[3][2] = 2;
+    linkindex[3][1] = 3; linkindex[1][2] = 4; linkindex[2][3] = 5;
+
+    norm = new double[2*semiwindow];
+    scratchweights = new double[2*semiwindow];
+    scratchrows = new double *[2*semiwindow];
+
+    for(int k=1-semiwindow;k<=semiwindow;k++) {
+        double den = 1.0;
+
+        for(int m=1-semiwindow;m<=semiwindow;m++)
+            if(m != k) den *= (k - m);
+
+        norm[k+semiwindow-1] = 1.0 / den;
+    }
+
+    chains = 0;
+    chainweights = 0;
+    chainrows = 0;
+
+    memostamp = 0;
+    memoactive = 0;
+}
+
+TwoStageTDI::~TwoStageTDI() {
+    for(int i=0;i<12;i++)
+        delete links[i];
+
+    delete [] norm;
+    delete [] scratchweights;
+    delete [] scratchrows;
+
+    delete [] chains;
+    delete [] chainweights;
+    delete [] chainrows;
+}
+
+// the links are sampled together, since they share the noise buffers of
+// basetdi, which would go stale if one link ran ahead of the others
+
+void TwoStageTDI::advance(long pos) {
+    for(long i=current+1;i<=pos;i++) {
+        double t = i * deltat - prebuffer;
+
+        for(int k=0;k<12;k++)
+            samples[12*i + k] = links[k]->value(t);
+
+        current = i;
+    }
+}
+
+inline int TwoStageTDI::filter(double time,long &ind,double *weights,double **rows) {
+    double ireal = (time + prebuffer) / deltat;
+
+    ind = (long)floor(ireal);
+    double x = ireal - ind;
+
+    if(ind + semiwindow > current)
+        advance(ind + semiwindow);
+
+    // the twelve links of a sample are contiguous in the ring buffer
+    // (of length 12*length), so the rows can be located once for all
+    // links, wrapping around without a division per row
+
+    if(ind + 1 - semiwindow >= 0) {
+        double *data = &samples[0];
+        long pos = 12 * ((ind + 1 - semiwindow) % length);
+
+        for(int j=0;j<2*semiwindow;j++) {
+            rows[j] = data + pos;
+
+            pos += 12;
+            if(pos == 12*length) pos = 0;
+        }
+    }
+
+    if(x == 0.0)
+        return 1;
+
+    // weight k is norm[k] times the product of (x - m) over the nodes
+    // m != k, built from the left and right partial products (which
+    // avoids dividing by x - k)
+
+    int nodes = 2*semiwindow;
+    double left = 1.0, right = 1.0;
+
+    for(int j=0;j<nodes;j++) {
+        weights[j] = left;
+        left *= x - (j + 1 - semiwindow);
+    }
+
+    for(int j=nodes-1;j>=0;j--) {
+        weights[j] *= norm[j] * right;
+        right *= x - (j + 1 - semiwindow);
+    }
+
+    return 0;
+}
+
+inline double TwoStageTDI::stream(int link,long ind,int exact,const double *weights,double *const *rows) {
+    if(ind - semiwindow + 1 < 0 || ind - semiwindow + 1 <= current - length) {
+        std::cerr << "TwoStageTDI::stream(" << link << "," << ind
+                  << "): stale or negative sample access [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+
+        ExceptionOutOfBounds e;
+        throw e;
+    }
+
+    if(exact)
+        return rows[semiwindow-1][link];
+
+    double sum = 0.0;
+
+    for(int k=0;k<2*semiwindow;k++)
+        sum += weights[k] * rows[k][link];
+
+    return sum;
+}
+
+// --- shared delay chains ---
+
+void TwoStageTDI::beginsample() {
+    if(!chains) {
+        chains = new chainentry[memosize];
+        chainweights = new double[memosize * 2 * semiwindow];
+        chainrows = new double *[memosize * 2 * semiwindow];
+
+        for(int k=0;k<memosize;k++) chains[k].stamp = -1;
+    }
+
+    // entries from previous samples become invalid
+
+    memostamp++;
+    memoactive = 1;
+}
+
+static inline int chainslot(unsigned long long key,int size) {
+    key *= 0x9e3779b97f4a7c15ULL;
+
+    return (int)((key >> 40) & (size - 1));
+}
+
+// the stream link, delayed by delay[0...delays-1] (applied in this order)
+// from time t; y and z of the same link and chain, and the different
+// links with the same chain, share the delays and the filter weights
+
+double TwoStageTDI::delayed(int link,const int *delay,int delays,double t) {
+    if(!memoactive) {
+        lisa->newretardtime(t);
+        for(int k=0;k<delays;k++) lisa->retard(delay[k]);
+
+        long ind;
+        int exact = filter(lisa->retardedtime(),ind,scratchweights,scratchrows);
+
+        return stream(link,ind,exact,scratchweights,scratchrows);
+    }
+
+    long key = 1;
+    for(int k=0;k<delays;k++) key = 8 * key + (delay[k] + 4);
+
+    int slot = chainslot(key,memosize);
+
+    chainentry &chain = chains[slot];
+
+    double *weights = &chainweights[slot * 2 * semiwindow];
+    double **rows = &chainrows[slot * 2 * semiwindow];
+
+    if(chain.stamp != memostamp || chain.key != key) {
+        lisa->newretardtime(t);
+        for(int k=0;k<delays;k++) lisa->retard(delay[k]);
+
+        chain.exact = filter(lisa->retardedtime(),chain.ind,weights,rows);
+
+        chain.key = key;
+        chain.stamp = memostamp;
+    }
+
+    return stream(link,chain.ind,chain.exact,weights,rows);
+}
+
+void TwoStageTDI::reset(unsigned long seed) {
+    basetdi->reset(seed);
+
+    samples.reset();
+    current = -1;
+}
+
+void TwoStageTDI::savestate(FILE *file) {
+    basetdi->savestate(file);
+    lisa->savestate(file);
+
+    savebytes(file,&current,sizeof(long));
+    samples.savestate(file);
+}
+
+void TwoStageTDI::loadstate(FILE *file) {
+    basetdi->loadstate(file);
+    lisa->loadstate(file);
+
+    loadbytes(file,&current,sizeof(long));
+    samples.loadstate(file);
+}
+
+void TwoStageTDI::addcounters(EventCounters &counters) {
+    basetdi->getcounters(counters);
+    lisa->getcounters(counters);
+}
+
+void TwoStageTDI::resetcounters() {
+    basetdi->resetcounters();
+    lisa->resetcounters();
+}
+
+double TwoStageTDI::y(int send, int slink, int recv, int ret1, int ret2, int ret3, double t) {
+    return y(send,slink,recv,ret1,ret2,ret3,0,0,0,0,t);
+}
+
+double TwoStageTDI::z(int send, int slink, int recv, int ret1, int ret2, int ret3, int ret4, double t) {
+    return z(send,slink,recv,ret1,ret2,ret3,ret4,0,0,0,0,t);
+}
+
+// retard(ret1) is applied last; retard(0) does nothing
+
+double TwoStageTDI::y(int send, int slink, int recv, int ret1, int ret2, int ret3, int ret4, int ret5, int ret6, int ret7, double t) {
+    int ret[7] = {ret7, ret6, ret5, ret4, ret3, ret2, ret1}, delay[7], delays = 0;
+
+    for(int r=0;r<7;r++)
+        if(ret[r] != 0) delay[delays++] = ret[r];
+
+    return delayed(linkindex[send][recv],delay,delays,t);
+}
+
+double TwoStageTDI::z(int send, int slink, int recv, int ret1, int ret2, int ret3, int ret4, int ret5, int ret6, int ret7, int ret8, double t) {
+    int ret[8] = {ret8, ret7, ret6, ret5, ret4, ret3, ret2, ret1}, delay[8], delays = 0;
+
+    for(int r=0;r<8;r++)
+        if(ret[r] != 0) delay[delays++] = ret[r];
+
+    return delayed(6 + linkindex[send][recv],delay,delays,t);
+}
+
+double TwoStageTDI::yterm(const TDIstep &s, double t) {
+    return delayed(linkindex[s.send][s.recv],s.delay,s.delays,t);
+}
+
+double TwoStageTDI::zterm(const TDIstep &s, double t) {
+    return delayed(6 + linkindex[s.send][s.recv],s.delay,s.delays,t);
+}
+
+TDIobject *TwoStageTDI::tableobject(const TDItable *table,int own) {
+    if(typeid(*this) != typeid(TwoStageTDI))
+        return 0;
+
+    return new TDItableobject<TwoStageTDI>(this,table,own);
+}
@@ -12,10 +12,14 @@
 
 #include <math.h>
 
+#include <vector>
+
 /* These objects could be returned by the main TDI class if the TDI functions are called without arguments! */
 /* Could also try an implementation with method pointers... but should check whether it's slower */
 
 class TDI;
+class TDItable;
+class TDIfused;
 
 class TDIobject : public Signal {
  protected:
@@ -26,6 +30,14 @@ class TDIobject : public Signal {
     virtual ~TDIobject() {};
         
     virtual double value(double t) = 0;
+
+    // for fused evaluation (see TDIfused): table-driven observables
+    // return their table, and can fuse tables of the same TDI object
+
+    TDI *gettdi() { return tdi; };
+
+    virtual const TDItable *gettable() { return 0; };
+    virtual TDIfused *fuse(const std::vector<const TDItable *> &tables) { return 0; };
 };
 
 class TDIobjectpnt : public TDIobject {
@@ -37,6 +49,14 @@ class TDIobjectpnt : public TDIobject {
     ~TDIobjectpnt() {};
     
     double value(double t) { return (tdi->*obs)(t); };
+
+    void values(const double *t,double *out,long n) {
+        for(long i=0;i<n;i++) out[i] = (tdi->*obs)(t[i]);
+    };
+
+    void values(const double *tb,const double *tc,double *out,long n) {
+        for(long i=0;i<n;i++) out[i] = (tdi->*obs)(tb[i] + tc[i]);
+    };
 };
 
 class timeobject : public Signal {
@@ -44,6 +64,267 @@ class timeobject : public Signal {
     timeobject() {};
     
     double value(double t) { return t; };
+
+    void values(const double *t,double *out,long n) {
+        for(long i=0;i<n;i++) out[i] = t[i];
+    };
+
+    void values(const double *tb,const double *tc,double *out,long n) {
+        for(long i=0;i<n;i++) out[i] = tb[i] + tc[i];
+    };
+};
+
+/* TDI combinations as tables of terms. Each term is sign * y(send,link,
+   recv,ret1,...,t) (or z), as written in the original hand-expanded
+   expressions; consecutive terms are collected into parenthesized
+   blocks (with a sign), and blocks into groups (with a scale, such as
+   the 0.5 in front of the z terms). The evaluator sums terms, blocks,
+   and groups in the same order as the expressions, so it reproduces
+   them exactly. */
+
+struct TDIterm {
+    double scale;   // nonzero if the term begins a group scaled by this factor
+    int block;      // nonzero if the term begins a block with this sign
+    int sign;
+
+    char kind;      // 'y' or 'z'
+    int send, link, recv;
+
+    int ret[8];     // ret1, ret2, ..., padded with zeros
+};
+
+// a term as evaluated: the link direction and the sequence of delays
+// (in the order they are applied, last one first, without zeros) are
+// worked out once, when the table is built
+
+struct TDIstep {
+    double scale;
+    int block, sign;
+
+    int z;
+    int send, slink, link, recv;
+
+    // cyclic is the test used by TDInoise, olink the oriented link used by TDIsignal
+
+    int cyclic, olink;
+
+    int delays;
+    int delay[8];
+
+    int ret[8];
+};
+
+class TDItable {
+ public:
+    const char *name;
+    std::vector<TDIstep> steps;
+
+    TDItable(const char *n,const TDIterm *terms,int count);
+
+    // the linear combination sum_k coeffs[k] * parts[k], as one table
+    // (the steps of the parts, with their group scales multiplied by
+    // the coefficients)
+
+    TDItable(const char *n,const TDItable *const *parts,const double *coeffs,int count);
+};
+
+// the built-in combinations (see TDI::observable for their names), or 0
+
+extern const TDItable *findtditable(const char *name);
+
+// a new table equivalent to table for a geometry with the given delay
+// symmetries (see LISA::delaysymmetry): each delay chain is rewritten
+// in a canonical form (with the delays sorted if they commute, without
+// their direction if it does not matter, all on one arm if the arms are
+// equal), then the terms that share link and canonical chain are merged
+// into one, with the sum of their coefficients, and dropped if these
+// cancel. The result equals the original up to rounding
+
+extern TDItable *simplifytable(const TDItable &table,int symmetry);
+
+// T must provide yterm(step,t) and zterm(step,t); when T is a concrete
+// TDI class, these calls are resolved (and inlined) at compile time
+
+template<class T> inline double evaltable(T *tdi,const TDItable &table,double t) {
+    double total = 0.0, group = 0.0, block = 0.0, scale = 1.0;
+    int sign = 1;
+
+    // (a simplified table can be empty)
+
+    if(table.steps.empty()) return 0.0;
+
+    const TDIstep *step = &table.steps[0], *end = step + table.steps.size();
+
+    for(;step < end;step++) {
+        if(step->block) {
+            group += sign * block;
+            block = 0.0; sign = step->block;
+        }
+
+        if(step->scale != 0.0) {
+            total += scale * group;
+            group = 0.0; scale = step->scale;
+        }
+
+        block += step->sign * (step->z ? tdi->zterm(*step,t) : tdi->yterm(*step,t));
+    }
+
+    group += sign * block;
+
+    return total + scale * group;
+}
+
+/* Several table-driven observables of the same TDI object, evaluated
+   together: terms that appear in more than one of them (or more than once)
+   are evaluated once per sample, then each combination is summed as in
+   evaltable, so the results are the same as for separate observables.
+   For TDInoise, the noise lookups at identical retarded times are also
+   shared within each sample (see TDInoise::beginsample). */
+
+class TDIfused {
+ public:
+    virtual ~TDIfused() {};
+
+    virtual int count() = 0;
+
+    // out[0...count()-1] = the observables at time t
+
+    virtual void values(double t,double *out) = 0;
+};
+
+// TDIfused for the observables thesignals[0...signals-1], or 0 unless
+// they are all table-driven observables of the same TDI object
+
+extern TDIfused *fuseobservables(Signal **thesignals,int signals);
+
+template<class T> class TDIfusedtable : public TDIfused {
+ private:
+    T *owner;
+
+    // the distinct terms, and their values at the current sample
+
+    std::vector<TDIstep> terms;
+    std::vector<double> termvalues;
+
+    // the combinations, as steps that refer to terms; observable j
+    // uses steps first[j]...first[j+1]-1
+
+    struct fusedstep {
+        double scale;
+        int block, sign;
+        int term;
+    };
+
+    std::vector<fusedstep> steps;
+    std::vector<int> first;
+
+    static int sameterm(const TDIstep &a,const TDIstep &b) {
+        if(a.z != b.z || a.send != b.send || a.slink != b.slink || a.recv != b.recv)
+            return 0;
+
+        for(int r=0;r<8;r++)
+            if(a.ret[r] != b.ret[r]) return 0;
+
+        return 1;
+    };
+
+ public:
+    TDIfusedtable(T *t,const std::vector<const TDItable *> &tables) : owner(t) {
+        for(unsigned int j=0;j<tables.size();j++) {
+            first.push_back(steps.size());
+
+            for(unsigned int k=0;k<tables[j]->steps.size();k++) {
+                const TDIstep &step = tables[j]->steps[k];
+
+                unsigned int u = 0;
+                while(u < terms.size() && !sameterm(terms[u],step)) u++;
+                if(u == terms.size()) terms.push_back(step);
+
+                fusedstep fstep = {step.scale, step.block, step.sign, (int)u};
+                steps.push_back(fstep);
+            }
+        }
+
+        first.push_back(steps.size());
+        termvalues.resize(terms.size());
+    };
+
+    int count() { return first.size() - 1; };
+
+    void values(double t,double *out) {
+        owner->beginsample();
+
+        try {
+            for(unsigned int u=0;u<terms.size();u++)
+                termvalues[u] = terms[u].z ? owner->zterm(terms[u],t) : owner->yterm(terms[u],t);
+        } catch (...) {
+            owner->endsample();
+            throw;
+        }
+
+        owner->endsample();
+
+        // same order of summation as evaltable
+
+        for(unsigned int j=0;j+1<first.size();j++) {
+            double total = 0.0, group = 0.0, block = 0.0, scale = 1.0;
+            int sign = 1;
+
+            for(int k=first[j];k<first[j+1];k++) {
+                const fusedstep &step = steps[k];
+
+                if(step.block) {
+                    group += sign * block;
+                    block = 0.0; sign = step.block;
+                }
+
+                if(step.scale != 0.0) {
+                    total += scale * group;
+                    group = 0.0; scale = step.scale;
+                }
+
+                block += step.sign * termvalues[step.term];
+            }
+
+            group += sign * block;
+
+            out[j] = total + scale * group;
+        }
+    };
+};
+
+template<class T> class TDItableobject : public TDIobject {
+ private:
+    T *owner;
+    const TDItable *table;
+
+    // user-defined tables (see TDI::combination) belong to the object
+
+    int owned;
+
+ public:
+    TDItableobject(T *t,const TDItable *tab,int own = 0) : TDIobject(t), owner(t), table(tab), owned(own) {};
+    ~TDItableobject() { if(owned) delete table; };
+
+    double value(double t) {
+        owner->beginsample();
+
+        try {
+            double ret = evaltable(owner,*table,t);
+
+            owner->endsample();
+            return ret;
+        } catch (...) {
+            owner->endsample();
+            throw;
+        }
+    };
+
+    const TDItable *gettable() { return table; };
+
+    TDIfused *fuse(const std::vector<const TDItable *> &tables) {
+        return new TDIfusedtable<T>(owner,tables);
+    };
 };
 
 class TDI {
@@ -51,61 +332,121 @@ class TDI {
     TDI() {};
     virtual ~TDI() {};
 
-    virtual void reset() {};
+    // reset noises and buffers; subclasses with pseudorandom noises
+    // reseed from seed, the others ignore it
+
+    virtual void reset(unsigned long seed = 0) {};
+
+    // checkpointing: save (restore) the state of the LISA and noise
+    // objects (see lisasim-signal.h), into a TDI object built identically
+
+    virtual void savestate(FILE *file) {};
+    virtual void loadstate(FILE *file) {};
+
+    // event counters of the LISA and noise objects (see lisasim-signal.h)
+
+    void getcounters(EventCounters &counters) {
+        if(counters.visit(this)) addcounters(counters);
+    };
+
+    virtual void addcounters(EventCounters &counters) {};
+    virtual void resetcounters() {};
+
+    // the combinations below are evaluated from their tables (see
+    // TDItable); observable() and the methods without arguments return
+    // tableobject(table) if the class provides one (as a TDItableobject
+    // that owns table if own is set)
+
+    virtual TDIobject *tableobject(const TDItable *table,int own = 0) { return 0; };
+
+    // called around the evaluation of the terms of one sample (see
+    // TDInoise, which shares noise lookups between them)
+
+    void beginsample() {};
+    void endsample() {};
+
+    // terms evaluated through the virtual y and z (for evaltable<TDI>)
+
+    double yterm(const TDIstep &s,double t) {
+        return y(s.send,s.slink,s.recv,s.ret[0],s.ret[1],s.ret[2],s.ret[3],s.ret[4],s.ret[5],s.ret[6],t);
+    };
+
+    double zterm(const TDIstep &s,double t) {
+        return z(s.send,s.slink,s.recv,s.ret[0],s.ret[1],s.ret[2],s.ret[3],s.ret[4],s.ret[5],s.ret[6],s.ret[7],t);
+    };
     
     virtual double alpham(double t);
-    TDIobject *alpham() { return new TDIobjectpnt(this,&TDI::alpham); };
+    TDIobject *alpham() { return observable("alpham"); };
     virtual double betam(double t);
-    TDIobject *betam()  { return new TDIobjectpnt(this,&TDI::betam);  };
+    TDIobject *betam()  { return observable("betam");  };
     virtual double gammam(double t);
-    TDIobject *gammam() { return new TDIobjectpnt(this,&TDI::gammam); };
+    TDIobject *gammam() { return observable("gammam"); };
 
     virtual double zetam(double t);
-    TDIobject *zetam()  { return new TDIobjectpnt(this,&TDI::zetam);  };
+    TDIobject *zetam()  { return observable("zetam");  };
 
     virtual double alpha1(double t);
-    TDIobject *alpha1() { return new TDIobjectpnt(this,&TDI::alpha1); };
+    TDIobject *alpha1() { return observable("alpha1"); };
     virtual double alpha2(double t);
-    TDIobject *alpha2() { return new TDIobjectpnt(this,&TDI::alpha2); };
+    TDIobject *alpha2() { return observable("alpha2"); };
     virtual double alpha3(double t);
-    TDIobject *alpha3() { return new TDIobjectpnt(this,&TDI::alpha3); };
+    TDIobject *alpha3() { return observable("alpha3"); };
 
     virtual double zeta1(double t);
-    TDIobject *zeta1() { return new TDIobjectpnt(this,&TDI::zeta1); };
+    TDIobject *zeta1() { return observable("zeta1"); };
     virtual double zeta2(double t);
-    TDIobject *zeta2() { return new TDIobjectpnt(this,&TDI::zeta2); };
+    TDIobject *zeta2() { return observable("zeta2"); };
     virtual double zeta3(double t);
-    TDIobject *zeta3() { return new TDIobjectpnt(this,&TDI::zeta3); };
+    TDIobject *zeta3() { return observable("zeta3"); };
 
     // P, E, U still have non-signed delays
     
     virtual double P(double t);
-    TDIobject *P() { return new TDIobjectpnt(this,&TDI::P); };
+    TDIobject *P() { return observable("P"); };
     virtual double E(double t);
-    TDIobject *E() { return new TDIobjectpnt(this,&TDI::E); };
+    TDIobject *E() { return observable("E"); };
     virtual double U(double t);
-    TDIobject *U() { return new TDIobjectpnt(this,&TDI::U); };
+    TDIobject *U() { return observable("U"); };
     
     virtual double Xm(double t);
-    TDIobject *Xm() { return new TDIobjectpnt(this,&TDI::Xm); };
+    TDIobject *Xm() { return observable("Xm"); };
     virtual double Ym(double t);
-    TDIobject *Ym() { return new TDIobjectpnt(this,&TDI::Ym); };
+    TDIobject *Ym() { return observable("Ym"); };
     virtual double Zm(double t);
-    TDIobject *Zm() { return new TDIobjectpnt(this,&TDI::Zm); };
+    TDIobject *Zm() { return observable("Zm"); };
 
     virtual double Xmlock1(double t);
-    TDIobject *Xmlock1() { return new TDIobjectpnt(this,&TDI::Xmlock1); };
+    TDIobject *Xmlock1() { return observable("Xmlock1"); };
     virtual double Xmlock2(double t);
-    TDIobject *Xmlock2() { return new TDIobjectpnt(this,&TDI::Xmlock2); };
+    TDIobject *Xmlock2() { return observable("Xmlock2"); };
     virtual double Xmlock3(double t);
-    TDIobject *Xmlock3() { return new TDIobjectpnt(this,&TDI::Xmlock3); };
+    TDIobject *Xmlock3() { return observable("Xmlock3"); };
     
     virtual double X1(double t);
-    TDIobject *X1() { return new TDIobjectpnt(this,&TDI::X1); };
+    TDIobject *X1() { return observable("X1"); };
     virtual double X2(double t);
-    TDIobject *X2() { return new TDIobjectpnt(this,&TDI::X2); };
+    TDIobject *X2() { return observable("X2"); };
     virtual double X3(double t);
-    TDIobject *X3() { return new TDIobjectpnt(this,&TDI::X3); };
+    TDIobject *X3() { return observable("X3"); };
+
+    // the noise-orthogonal combinations A = (gamma - alpha)/sqrt(2),
+    // E = (alpha - 2 beta + gamma)/sqrt(6), T = (alpha + beta + gamma)/sqrt(3),
+    // from alpham, betam, gammam (Am, Em, Tm) and from alpha1, alpha2,
+    // alpha3 (A1, E1, T1); Em is not to be confused with the Sagnac E
+
+    virtual double Am(double t);
+    TDIobject *Am() { return observable("Am"); };
+    virtual double Em(double t);
+    TDIobject *Em() { return observable("Em"); };
+    virtual double Tm(double t);
+    TDIobject *Tm() { return observable("Tm"); };
+
+    virtual double A1(double t);
+    TDIobject *A1() { return observable("A1"); };
+    virtual double E1(double t);
+    TDIobject *E1() { return observable("E1"); };
+    virtual double T1(double t);
+    TDIobject *T1() { return observable("T1"); };
 
     virtual double y(int send, int link, int recv, int ret1, int ret2, int ret3, double t) { return 0.0; };
     virtual double z(int send, int link, int recv, int ret1, int ret2, int ret3, int ret4, double t) { return 0.0; };
@@ -145,11 +486,93 @@ class TDI {
     timeobject *time() { return new timeobject(); };
     double t(double t)    { return t;};
     timeobject *t()    { return new timeobject(); };
+
+    // return a new TDIobject for the observable with the given name
+    // (e.g., "X1"), or 0 if the name is not known
+
+    TDIobject *observable(const char *name);
+
+    // return a new TDIobject for the user-defined combination
+    // sum_k scale_k * y (or z) of the terms (block and sign are ignored);
+    // the terms are checked (and ExceptionUndefined is thrown if one is
+    // not valid), then compiled into a TDItable like the built-in ones,
+    // and simplified for the delay symmetries of geometry if given
+
+    TDIobject *combination(const TDIterm *theterms,int terms,LISA *geometry = 0);
+
+    // return a new TDIobject for the built-in combination name, simplified
+    // for the delay symmetries of geometry (see simplifytable), which
+    // should be the LISA object used for the delays, or 0 if the name
+    // is not known
+
+    TDIobject *simplified(const char *name,LISA *geometry);
 };
 
 extern void fastgetobs(double *buffer,long length,long samples,double stime,Signal **thesignals,int signals,double inittime);
 extern void fastgetobsc(double *buffer,long length,long samples,double stime,Signal **thesignals,int signals,double inittime);
 
+// fill buffer with samples offset...offset+samples-1 (at times inittime +
+// stime * i), continuing a previous fastgetobs or fastgetobschunk call on
+// the same observables
+
+extern void fastgetobschunk(double *buffer,long length,long samples,double stime,Signal **thesignals,int signals,double inittime,long offset);
+
+// evaluate the observables at the (sorted) times[0...samples-1]
+
+extern void fastgetobstimes(double *buffer,long length,double *times,long samples,Signal **thesignals,int signals);
+
+// decimated output: the observables are evaluated at cadence stime, and
+// filtered with the FIR filter[0...taps-1] (centered on output samples,
+// which are spaced by decimation*stime), without storing the full-rate
+// series; filtering is done only at the output points. No observable is
+// evaluated before inittime, so output k is centered on time
+// inittime + ((taps-1)/2 + k*decimation)*stime
+
+extern void fastgetobsdec(double *buffer,long length,long samples,double stime,Signal **thesignals,int signals,double inittime,int decimation,double *filter,int taps);
+
+// single-precision output (computed in double precision); with offset,
+// same as fastgetobschunk; with display, same as fastgetobsc
+
+extern void fastgetobsf(float *buffer,long length,long samples,double stime,Signal **thesignals,int signals,double inittime,long offset = 0,int display = 0);
+
+// streaming versions: the observables are written batch by batch (as
+// native-endian doubles, or floats if single is set, row after row, as in
+// lisaXML Binary streams) to the open file descriptor fd, or to the file
+// filename; memory use does not depend on samples; with offset, the
+// samples written are offset...offset+samples-1, as in fastgetobschunk; the batches
+// are written by a separate thread while the next ones are computed, with
+// at most four batches in flight
+
+extern void fastgetobsfd(int fd,long samples,double stime,Signal **thesignals,int signals,double inittime,int display = 0,int single = 0,long offset = 0);
+extern void fastgetobsfile(const char *filename,long samples,double stime,Signal **thesignals,int signals,double inittime,int display = 0,int append = 0,int single = 0,long offset = 0);
+
+// cancel all the fastgetobs runs currently in progress; they will throw
+// ExceptionCancelled at their next check (between batches)
+
+extern void cancelobs();
+
+// used by the fastgetobs functions: obsepoch() is taken when a run starts,
+// and checkinterrupt(epoch) throws ExceptionCancelled if cancelobs() was
+// called since then, or ExceptionKeyboardInterrupt if (with python = 1)
+// the interrupt hook returns nonzero; the Python layer installs a hook
+// that runs Python signal handlers (e.g., for Ctrl-C), but the core
+// library itself does not depend on Python
+
+extern long obsepoch();
+extern void checkinterrupt(long epoch,int python = 1);
+
+extern void setinterrupthook(int (*hook)());
+
+// checkpoints for long runs: savecheckpoint writes the state of tdi
+// (and of all the objects it uses), tagged with the index "offset" of the
+// next sample to compute, to filename (atomically, through filename.tmp);
+// loadcheckpoint restores it into a TDI object built identically (same
+// LISA, noise seeds, and buffer lengths), and returns offset, so that the
+// run can be continued with fastgetobschunk or fastgetobsfile
+
+extern void savecheckpoint(const char *filename,TDI *tdi,long offset);
+extern long loadcheckpoint(const char *filename,TDI *tdi);
+
 class TDIquantize : public TDI {
  private:
     TDI *basetdi;
@@ -171,6 +594,14 @@ class TDIquantize : public TDI {
     
     virtual ~TDIquantize() {};
 
+    void reset(unsigned long seed = 0) { basetdi->reset(seed); };
+
+    void savestate(FILE *file) { basetdi->savestate(file); };
+    void loadstate(FILE *file) { basetdi->loadstate(file); };
+
+    void addcounters(EventCounters &counters) { basetdi->getcounters(counters); };
+    void resetcounters() { basetdi->resetcounters(); };
+
     virtual double y(int send, int link, int recv, int ret1, int ret2, int ret3, double t) {
     	return quantize(basetdi->y(send, link, recv, ret1, ret2, ret3, t));
     };
@@ -200,6 +631,12 @@ class SampledTDI : public TDI {
 
     void reset(unsigned long seed = 0);
 
+    void savestate(FILE *file);
+    void loadstate(FILE *file);
+
+    void addcounters(EventCounters &counters);
+    void resetcounters();
+
     double y(int send, int link, int recv, int ret1, int ret2, int ret3, double t);
     double z(int send, int link, int recv, int ret1, int ret2, int ret3, int ret4, double t);
 
@@ -212,10 +649,106 @@ class SampledTDIaccurate : public SampledTDI {
     SampledTDIaccurate(LISA *lisa,Noise *yijk[6],Noise *zijk[6]) : SampledTDI(lisa,yijk,zijk) {};
     ~SampledTDIaccurate() {};
 
+    double y(int send, int link, int recv, int ret1, int ret2, int ret3, int ret4, int ret5, int ret6, int ret7, double t);
+    double z(int send, int link, int recv, int ret1, int ret2, int ret3, int ret4, int ret5, int ret6, int ret7, int ret8, double t);
+};
+
+// two-stage TDI: the six y and the six z link measurements of basetdi are
+// sampled together, once each every deltat seconds, into a buffer of the
+// given length; the combinations are then formed from these twelve
+// streams, applying the delays of lisa (which can be a CacheLengthLISA)
+// with Lagrange fractional-delay filters over 2*interplen samples. The
+// cost of basetdi is then paid once per link and sample, rather than
+// once per term. In stage two, the retarded time, filter weights and
+// buffer rows are computed once per sample for each distinct delay
+// chain, and shared by all the terms (of all the observables evaluated
+// together) delayed by it; what remains per term is a 2*interplen-tap
+// sum. Since the delays vary in time, stage two still scales with the
+// number of distinct (link, delay chain) terms. The buffer must span
+// the longest delay chain of the combinations used (about eight
+// armlengths for X1) plus interplen samples. The streams begin eight
+// armlengths plus interplen samples before t = 0, so observables can be
+// evaluated from t = 0 on. As in
+// the real instrument, the laser noise cancels only to the extent that
+// the filters reproduce it, so it should be band-limited well below the
+// Nyquist frequency of deltat
+
+class TwoStageTDI : public TDI {
+ private:
+    LISA *lisa;
+    TDI *basetdi;
+
+    // stage one: link k is stored at samples[12*pos + k], for the time
+    // pos * deltat - prebuffer; y links are 0...5, z links 6...11
+
+    TDIobject *links[12];
+    int linkindex[4][4];
+
+    RingBuffer samples;
+    long length, current;
+    double deltat, prebuffer;
+
+    void advance(long pos);
+
+    // stage two: Lagrange weights are norm[k] * prod_{m != k} (x - m),
+    // for nodes k = 1 - semiwindow...semiwindow; filter sets ind, the
+    // weights and the buffer rows for the given time, and returns 1 if
+    // the time falls on sample ind (which is then used as is)
+
+    int semiwindow;
+    double *norm;
+
+    double *scratchweights, **scratchrows;
+
+    int filter(double time,long &ind,double *weights,double **rows);
+    double stream(int link,long ind,int exact,const double *weights,double *const *rows);
+
+    double delayed(int link,const int *delay,int delays,double t);
+
+    // between beginsample and endsample, the filters are kept per delay
+    // chain, and shared by all the links delayed by it (chains are coded
+    // as 1 followed by one octal digit delay + 4 per delay)
+
+    struct chainentry {
+        long key, stamp, ind;
+        int exact;
+    };
+
+    static const int memosize = 256;
+
+    chainentry *chains;
+    double *chainweights, **chainrows;
+
+    long memostamp;
+    int memoactive;
+
+ public:
+    TwoStageTDI(LISA *lisa,TDI *basetdi,long length,double deltat,int interplen = 4);
+    ~TwoStageTDI();
+
     void reset(unsigned long seed = 0);
 
+    void savestate(FILE *file);
+    void loadstate(FILE *file);
+
+    void addcounters(EventCounters &counters);
+    void resetcounters();
+
+    double y(int send, int link, int recv, int ret1, int ret2, int ret3, double t);
+    double z(int send, int link, int recv, int ret1, int ret2, int ret3, int ret4, double t);
+
     double y(int send, int link, int recv, int ret1, int ret2, int ret3, int ret4, int ret5, int ret6, int ret7, double t);
     double z(int send, int link, int recv, int ret1, int ret2, int ret3, int ret4, int ret5, int ret6, int ret7, int ret8, double t);
+
+    // table-driven combinations (see TDItable)
+
+    double yterm(const TDIstep &s, double t);
+    double zterm(const TDIstep &s, double t);
+
+    TDIobject *tableobject(const TDItable *table,int own = 0);
+
+    void beginsample();
+    void endsample() { memoactive = 0; };
 };
 
 #endif /* _LISASIM_TDI_H_ */
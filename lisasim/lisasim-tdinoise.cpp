@@ -8,107 +8,133 @@
 #include "lisasim-except.h"
 
 #include <time.h>
+#include <stdlib.h>
+#include <string.h>
 #include <iostream>
+#include <typeinfo>
 
 // this version takes the parameters of the basic noises and lets us allocate objects as needed
 
 TDInoise::TDInoise(LISA *mylisa, double stproof, double sdproof, double stshot, double sdshot, double stlaser, double sdlaser) {
+    memo = 0;
+    memostamp = 0;
+    memoactive = 0;
+
     phlisa = mylisa->physlisa();
     lisa = mylisa;
 
-    // allocate noise objects
-
-    // set the global random-number seed if it is not set already
-    WhiteNoiseSource::getglobalseed();
-
-    for(int craft = 1; craft <= 3; craft++) {
-        pm[craft] = stdproofnoise(lisa,stproof,sdproof);
-        pms[craft] = stdproofnoise(lisa,stproof,sdproof);
-    }
-        
-    for(int craft1 = 1; craft1 <= 3; craft1++) {
-        for(int craft2 = 1; craft2 <= 3; craft2++) {
-            if(craft1 != craft2)
-                shot[craft1][craft2] = stdopticalnoise(lisa,stshot,sdshot);
-        }
-    }
+    double stp[6], sdp[6], sts[6], sds[6], stl[6], sdl[6];
 
-    for(int craft = 1; craft <= 3; craft++) {
-		c[craft] = stdlasernoise(lisa,stlaser,sdlaser);
-        cs[craft] = stdlasernoise(lisa,stlaser,sdlaser);
+    for(int i = 0; i < 6; i++) {
+        stp[i] = stproof; sdp[i] = sdproof;
+        sts[i] = stshot;  sds[i] = sdshot;
+        stl[i] = stlaser; sdl[i] = sdlaser;
     }
 
-    allocated = 1;
+    stdnoises(stp,sdp,sts,sds,stl,sdl);
 }
 
 // this version takes arrays of basic-noise parameters, allowing for different noises on different objects,
 // and lets us allocate objects as needed
 
 TDInoise::TDInoise(LISA *mylisa, double *stproof, double *sdproof, double *stshot, double *sdshot, double *stlaser, double *sdlaser) {
+    memo = 0;
+    memostamp = 0;
+    memoactive = 0;
+
     phlisa = mylisa->physlisa();
     lisa = mylisa;
 
-    // allocate noise objects
-    // the convention is {1,1*,2,2*,3,3*}, and {12,21,23,32,31,13}
+    stdnoises(stproof,sdproof,stshot,sdshot,stlaser,sdlaser);
+}
+
+// this version takes pointers to noise objects, allowing for user-specified noises on different objects
 
-    // set the global random-number seed if it is not set already
-    WhiteNoiseSource::getglobalseed();
+TDInoise::TDInoise(LISA *mylisa, Noise *proofnoise[6],Noise *shotnoise[6],Noise *lasernoise[6]) {
+    memo = 0;
+    memostamp = 0;
+    memoactive = 0;
+
+    phlisa = mylisa->physlisa();
+    lisa = mylisa;
 
+    setnoises(proofnoise,shotnoise,lasernoise);
+
+    allocated = 0;
+    bank = 0;
+}
+
+// the convention is {1,1*,2,2*,3,3*}, and {12,21,23,32,31,13}
+
+static inline int shotindex(int craft1, int craft2) {
+    if( (craft1 == 1 && craft2 == 2) || (craft1 == 2 && craft2 == 3) || (craft1 == 3 && craft2 == 1) )
+        return 2*(craft1-1);
+    else
+        return 2*(craft2-1)+1;
+}
+
+void TDInoise::setnoises(Noise *proofnoise[6],Noise *shotnoise[6],Noise *lasernoise[6]) {
     for(int craft = 1; craft <= 3; craft++) {
-        pm[craft]  = stdproofnoise(lisa,stproof[2*(craft-1)],  sdproof[2*(craft-1)]);
-        pms[craft] = stdproofnoise(lisa,stproof[2*(craft-1)+1],sdproof[2*(craft-1)+1]);
+        pm[craft] = proofnoise[2*(craft-1)];
+        pms[craft] = proofnoise[2*(craft-1)+1];
     }
         
     for(int craft1 = 1; craft1 <= 3; craft1++) {
         for(int craft2 = 1; craft2 <= 3; craft2++) {
-            if(craft1 != craft2) {
-				if( (craft1 == 1 && craft2 == 2) || (craft1 == 2 && craft2 == 3) || (craft1 == 3 && craft2 == 1) )
-		    		shot[craft1][craft2] = stdopticalnoise(lisa,stshot[2*(craft1-1)],  sdshot[2*(craft1-1)]);
-				else
-		    		shot[craft1][craft2] = stdopticalnoise(lisa,stshot[2*(craft2-1)+1],sdshot[2*(craft2-1)+1]);
-	    	}
+            if(craft1 != craft2)
+                shot[craft1][craft2] = shotnoise[shotindex(craft1,craft2)];
         }
     }
 
     for(int craft = 1; craft <= 3; craft++) {
-        c[craft]  = stdlasernoise(lisa,stlaser[2*(craft-1)],  sdlaser[2*(craft-1)]);
-        cs[craft] = stdlasernoise(lisa,stlaser[2*(craft-1)+1],sdlaser[2*(craft-1)+1]);
+        c[craft] = lasernoise[2*(craft-1)];
+        cs[craft] = lasernoise[2*(craft-1)+1];
     }
-
-    allocated = 1;
 }
 
-// this version takes pointers to noise objects, allowing for user-specified noises on different objects
+// allocate the standard noises for the parameter constructors
 
-TDInoise::TDInoise(LISA *mylisa, Noise *proofnoise[6],Noise *shotnoise[6],Noise *lasernoise[6]) {
-    phlisa = mylisa->physlisa();
-    lisa = mylisa;
+void TDInoise::stdnoises(double *stproof, double *sdproof, double *stshot, double *sdshot, double *stlaser, double *sdlaser) {
+    // the noises take consecutive global seeds in the order pm, pms (by
+    // craft), shot[1][2], shot[1][3], shot[2][1], ..., c, cs (by craft)
 
-    // set noise objects
-    // the convention is {1,1*,2,2*,3,3*}, and {12,21,23,32,31,13}
+    unsigned long seeds[18];
 
     for(int craft = 1; craft <= 3; craft++) {
-        pm[craft] = proofnoise[2*(craft-1)];
-        pms[craft] = proofnoise[2*(craft-1)+1];
+        seeds[2*(craft-1)]   = WhiteNoiseSource::nextseed();
+        seeds[2*(craft-1)+1] = WhiteNoiseSource::nextseed();
     }
-        
+
     for(int craft1 = 1; craft1 <= 3; craft1++) {
         for(int craft2 = 1; craft2 <= 3; craft2++) {
-            if(craft1 != craft2) {
-				if( (craft1 == 1 && craft2 == 2) || (craft1 == 2 && craft2 == 3) || (craft1 == 3 && craft2 == 1) )
-		    		shot[craft1][craft2] = shotnoise[2*(craft1-1)];
-				else
-		    		shot[craft1][craft2] = shotnoise[2*(craft2-1)+1];
-	    	}
+            if(craft1 != craft2)
+                seeds[6 + shotindex(craft1,craft2)] = WhiteNoiseSource::nextseed();
         }
     }
 
     for(int craft = 1; craft <= 3; craft++) {
-        c[craft] = lasernoise[2*(craft-1)];
-        cs[craft] = lasernoise[2*(craft-1)+1];
+        seeds[12 + 2*(craft-1)]   = WhiteNoiseSource::nextseed();
+        seeds[12 + 2*(craft-1)+1] = WhiteNoiseSource::nextseed();
     }
 
-    allocated = 0;
+    Noise *noises[18];
+
+    bank = stdnoisebank(lisa,stproof,sdproof,stshot,sdshot,stlaser,sdlaser,seeds);
+
+    if(bank) {
+        for(int k = 0; k < 18; k++)
+            noises[k] = bank->channel(k);
+    } else {
+        for(int k = 0; k < 6; k++) {
+            noises[k]      = stdproofnoise(lisa,stproof[k],sdproof[k],1,seeds[k]);
+            noises[6 + k]  = stdopticalnoise(lisa,stshot[k],sdshot[k],1,seeds[6 + k]);
+            noises[12 + k] = stdlasernoise(lisa,stlaser[k],sdlaser[k],1,seeds[12 + k]);
+        }
+    }
+
+    setnoises(&noises[0],&noises[6],&noises[12]);
+
+    allocated = 1;
 }
 
 void TDInoise::setphlisa(LISA *mylisa) {
@@ -226,6 +252,8 @@ void TDInoise::lock(int master) {
 }
 
 TDInoise::~TDInoise() {
+    delete [] memo;
+
     if(allocated) {
 		// allow for one noise object to be contained in multiple pointers
 		// without calling delete twice
@@ -254,6 +282,10 @@ TDInoise::~TDInoise() {
 	    	if(c[craft])  {delete c[craft]; c[craft]=0;}
 	    	if(cs[craft]) {delete cs[craft]; cs[craft]=0;}
 		}
+
+		// the NoiseBank goes after all the channels that read it
+
+		delete bank;
     }
 }
 
@@ -287,6 +319,94 @@ void TDInoise::reset(unsigned long seed) {
     if(phlisa != lisa) phlisa->reset();
 }
 
+void TDInoise::savestate(FILE *file) {
+    for(int craft = 1; craft <= 3; craft++) {
+        pm[craft]->savestate(file);
+        pms[craft]->savestate(file);
+    }
+
+    for(int craft1 = 1; craft1 <= 3; craft1++) {
+        for(int craft2 = 1; craft2 <= 3; craft2++) {
+            if(craft1 != craft2)
+                shot[craft1][craft2]->savestate(file);
+        }
+    }
+
+    for(int craft = 1; craft <= 3; craft++) {
+        c[craft]->savestate(file);
+        cs[craft]->savestate(file);
+    }
+
+    lisa->savestate(file);
+    if(phlisa != lisa) phlisa->savestate(file);
+}
+
+void TDInoise::loadstate(FILE *file) {
+    for(int craft = 1; craft <= 3; craft++) {
+        pm[craft]->loadstate(file);
+        pms[craft]->loadstate(file);
+    }
+
+    for(int craft1 = 1; craft1 <= 3; craft1++) {
+        for(int craft2 = 1; craft2 <= 3; craft2++) {
+            if(craft1 != craft2)
+                shot[craft1][craft2]->loadstate(file);
+        }
+    }
+
+    for(int craft = 1; craft <= 3; craft++) {
+        c[craft]->loadstate(file);
+        cs[craft]->loadstate(file);
+    }
+
+    lisa->loadstate(file);
+    if(phlisa != lisa) phlisa->loadstate(file);
+}
+
+void TDInoise::addcounters(EventCounters &counters) {
+    for(int craft = 1; craft <= 3; craft++) {
+        pm[craft]->getcounters(counters);
+        pms[craft]->getcounters(counters);
+    }
+
+    for(int craft1 = 1; craft1 <= 3; craft1++) {
+        for(int craft2 = 1; craft2 <= 3; craft2++) {
+            if(craft1 != craft2)
+                shot[craft1][craft2]->getcounters(counters);
+        }
+    }
+
+    for(int craft = 1; craft <= 3; craft++) {
+        c[craft]->getcounters(counters);
+        cs[craft]->getcounters(counters);
+    }
+
+    lisa->getcounters(counters);
+    phlisa->getcounters(counters);
+}
+
+void TDInoise::resetcounters() {
+    for(int craft = 1; craft <= 3; craft++) {
+        pm[craft]->resetcounters();
+        pms[craft]->resetcounters();
+    }
+
+    for(int craft1 = 1; craft1 <= 3; craft1++) {
+        for(int craft2 = 1; craft2 <= 3; craft2++) {
+            if(craft1 != craft2)
+                shot[craft1][craft2]->resetcounters();
+        }
+    }
+
+    for(int craft = 1; craft <= 3; craft++) {
+        c[craft]->resetcounters();
+        cs[craft]->resetcounters();
+    }
+
+    lisa->resetcounters();
+    phlisa->resetcounters();
+}
+
 // this is a debugging function, which appears in lisasim-swig.i
 
 double retardation(LISA *lisa,int ret1,int ret2,int ret3,int ret4,int ret5,int ret6,int ret7,int ret8,double t) {
@@ -302,6 +422,80 @@ double TDInoise::y(int send, int slink, int recv, int ret1, int ret2, int ret3,
     return y(send,slink,recv,ret1,ret2,ret3,0,0,0,0,t);
 }
 
+// --- shared noise lookups ---
+
+void TDInoise::beginsample() {
+    if(!memo) {
+        memo = new memoentry[memosize];
+
+        for(int k=0;k<memosize;k++) memo[k].stamp = -1;
+    }
+
+    // entries from previous samples become invalid
+
+    memostamp++;
+    memoactive = 1;
+}
+
+inline double TDInoise::noisevalue(Noise *noise, double time) {
+    if(!memoactive) return (*noise)[time];
+
+    unsigned long long bits;
+    memcpy(&bits,&time,sizeof(double));
+
+    bits ^= (unsigned long long)(size_t)noise >> 4;
+    bits ^= (bits >> 29) ^ (bits >> 41);
+
+    memoentry &entry = memo[bits & (memosize - 1)];
+
+    if(entry.stamp != memostamp || entry.noise != noise || entry.time != time) {
+        entry.value = (*noise)[time];
+
+        entry.noise = noise;
+        entry.time = time;
+        entry.stamp = memostamp;
+    }
+
+    return entry.value;
+}
+
+// the noises combined in y and z, once the retarded time is known
+
+inline double TDInoise::ynoise(int send, int link, int recv, int cyclic, double retardedtime) {
+    if(cyclic) {
+        // cyclic combination
+        // if introducing error in the determination of the armlengths, it should not enter
+        // the following (physical) retardation of the laser noise, so we use the phlisa object
+
+        lisa->retard(phlisa,link);
+        double retardlaser = lisa->retardedtime();
+    
+        return( noisevalue(cs[send],retardlaser) - 2.0 * noisevalue(pm[recv],retardedtime)  - noisevalue(c[recv],retardedtime)  + 
+                noisevalue(shot[send][recv],retardedtime) );
+    } else {
+        // anticyclic combination
+        // ditto here
+
+        lisa->retard(phlisa,-link);
+        double retardlaser = lisa->retardedtime();
+
+        return( noisevalue(c[send],retardlaser)  + 2.0 * noisevalue(pms[recv],retardedtime) - noisevalue(cs[recv],retardedtime) +
+                noisevalue(shot[send][recv],retardedtime) );
+    }
+}
+
+inline double TDInoise::znoise(int recv, int cyclic, double retardedtime) {
+    if(cyclic) {
+        // cyclic combination
+
+        return( noisevalue(cs[recv],retardedtime) - 2.0 * noisevalue(pms[recv],retardedtime) - noisevalue(c[recv],retardedtime) );
+    } else {
+        // anticyclic combination
+
+        return( noisevalue(c[recv],retardedtime)  + 2.0 * noisevalue(pm[recv],retardedtime)  - noisevalue(cs[recv],retardedtime) );
+    }
+}
+
 double TDInoise::y(int send, int slink, int recv, int ret1, int ret2, int ret3, int ret4, int ret5, int ret6, int ret7, double t) {
     int link = abs(slink);
 
@@ -315,26 +509,7 @@ double TDInoise::y(int send, int slink, int recv, int ret1, int ret2, int ret3,
     double retardedtime = lisa->retardedtime();
 
     try {
-        if( (link == 3 && recv == 1) || (link == 2 && recv == 3) || (link == 1 && recv == 2)) {
-            // cyclic combination
-            // if introducing error in the determination of the armlengths, it should not enter
-            // the following (physical) retardation of the laser noise, so we use the phlisa object
-    
-            lisa->retard(phlisa,link);
-            double retardlaser = lisa->retardedtime();
-        
-            return( (*cs[send])[retardlaser] - 2.0 * (*pm[recv])[retardedtime]  - (*c[recv])[retardedtime]  + 
-                    (*shot[send][recv])[retardedtime] );
-        } else {
-            // anticyclic combination
-            // ditto here
-    
-            lisa->retard(phlisa,-link);
-            double retardlaser = lisa->retardedtime();
-    
-            return( (*c[send])[retardlaser]  + 2.0 * (*pms[recv])[retardedtime] - (*cs[recv])[retardedtime] +
-                    (*shot[send][recv])[retardedtime] );
-        }
+        return ynoise(send,link,recv,(link == 3 && recv == 1) || (link == 2 && recv == 3) || (link == 1 && recv == 2),retardedtime);
     } catch (ExceptionOutOfBounds &e) {
 		std::cerr << "TDInoise::y(" << send << "," << slink << "," << recv
 		          << "," << ret1 << "," << ret2 << "," << ret3 << "," << ret4
@@ -364,15 +539,7 @@ double TDInoise::z(int send, int slink, int recv, int ret1, int ret2, int ret3,
     double retardedtime = lisa->retardedtime();
 
     try {
-        if( (link == 3 && recv == 1) || (link == 2 && recv == 3) || (link == 1 && recv == 2)) {
-            // cyclic combination
-    
-            return( (*cs[recv])[retardedtime] - 2.0 * (*pms[recv])[retardedtime] - (*c[recv])[retardedtime] );
-        } else {
-            // anticyclic combination
-    
-            return( (*c[recv])[retardedtime]  + 2.0 * (*pm[recv])[retardedtime]  - (*cs[recv])[retardedtime] );
-        }
+        return znoise(recv,(link == 3 && recv == 1) || (link == 2 && recv == 3) || (link == 1 && recv == 2),retardedtime);
     } catch (ExceptionOutOfBounds &e) {
 		std::cerr << "TDInoise::z(" << send << "," << slink << "," << recv
 		          << "," << ret1 << "," << ret2 << "," << ret3 << "," << ret4
@@ -384,6 +551,53 @@ double TDInoise::z(int send, int slink, int recv, int ret1, int ret2, int ret3,
     }
 }
 
+// table terms: same as y and z, but with the delays and the link
+// direction worked out in advance, and without virtual calls
+
+double TDInoise::yterm(const TDIstep &s, double t) {
+    lisa->newretardtime(t);
+    for(int k=0;k<s.delays;k++) lisa->retard(s.delay[k]);
+
+    double retardedtime = lisa->retardedtime();
+
+    try {
+        return ynoise(s.send,s.link,s.recv,s.cyclic,retardedtime);
+    } catch (ExceptionOutOfBounds &e) {
+		std::cerr << "TDInoise::yterm(" << s.send << "," << s.slink << "," << s.recv
+		          << ",...) : could not get noise (OutOfBounds) at time "
+		          << t << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+		
+		throw e;
+    }
+}
+
+double TDInoise::zterm(const TDIstep &s, double t) {
+    lisa->newretardtime(t);
+    for(int k=0;k<s.delays;k++) lisa->retard(s.delay[k]);
+
+    double retardedtime = lisa->retardedtime();
+
+    try {
+        return znoise(s.recv,s.cyclic,retardedtime);
+    } catch (ExceptionOutOfBounds &e) {
+		std::cerr << "TDInoise::zterm(" << s.send << "," << s.slink << "," << s.recv
+		          << ",...) : could not get noise (OutOfBounds) at time "
+		          << t << " [" << __FILE__ << ":" << __LINE__ << "]." << std::endl;
+		
+		throw e;
+    }
+}
+
+TDIobject *TDInoise::tableobject(const TDItable *table,int own) {
+    // TDIaccurate and the other subclasses redefine y and z, so they
+    // must go through the virtual functions
+
+    if(typeid(*this) != typeid(TDInoise))
+        return 0;
+
+    return new TDItableobject<TDInoise>(this,table,own);
+}
+
 // standard noises for TDI, with utility function
 
 double lighttime(LISA *lisa) {
@@ -403,40 +617,66 @@ double lighttime(LISA *lisa) {
 
 // --- Standard Noise factories ---
 
-Noise *stdproofnoise(LISA *lisa,double stproof,double sdproof,int interp) {
-    // create InterpolateNoise objects for proof-mass noises
-    // we need quadruple retardations for the V's appearing in the z's
-    // (octuple for 2nd-gen TDI)
+// we need quadruple retardations for the V's appearing in the z's
+// (octuple for 2nd-gen TDI), only triple retardations for the shot's
+// appearing in the y's (septuple for 2nd-gen TDI); add two sampling
+// times to allow linear interpolation for large sampling times
 
-    // add two sampling times to allow linear interpolation for large
-    // sampling times
-    
-    double pbtproof = 8.0 * lighttime(lisa) + 2.0*stproof;
+static double pbtproof(LISA *lisa,double stproof) {
+    return 8.0 * lighttime(lisa) + 2.0*stproof;
+}
 
-	return new PowerLawNoise(stproof,pbtproof,sdproof,-2.0,interp);
+static double pbtshot(LISA *lisa,double stshot) {
+    return 7.0 * lighttime(lisa) + 2.0*stshot;
 }
 
+static double pbtlaser(LISA *lisa,double stlaser) {
+    return 8.0 * lighttime(lisa) + 2.0*stlaser;
+}
 
-Noise *stdopticalnoise(LISA *lisa,double stshot,double sdshot,int interp) {
-    // create InterpolateNoise objects for optical-path noises
-    // we need only triple retardations for the shot's appearing in the y's
-    // (septuple for 2nd-gen TDI)
+Noise *stdproofnoise(LISA *lisa,double stproof,double sdproof,int interp,unsigned long seed) {
+    // create InterpolateNoise objects for proof-mass noises
 
-    // add two sampling times to allow linear interpolation for large
-    // sampling times
-    
-    double pbtshot = 7.0 * lighttime(lisa) + 2.0*stshot;
+	return new PowerLawNoise(stproof,pbtproof(lisa,stproof),sdproof,-2.0,interp,seed);
+}
+
+
+Noise *stdopticalnoise(LISA *lisa,double stshot,double sdshot,int interp,unsigned long seed) {
+    // create InterpolateNoise objects for optical-path noises
     
-    return new PowerLawNoise(stshot,pbtshot,sdshot,2.0,interp);
+    return new PowerLawNoise(stshot,pbtshot(lisa,stshot),sdshot,2.0,interp,seed);
 }
 
 
-Noise *stdlasernoise(LISA *lisa,double stlaser,double sdlaser,int interp) {
+Noise *stdlasernoise(LISA *lisa,double stlaser,double sdlaser,int interp,unsigned long seed) {
     // create laser noise objects
 
-    double pbtlaser = 8.0 * lighttime(lisa) + 2.0*stlaser;
+    return new PowerLawNoise(stlaser,pbtlaser(lisa,stlaser),sdlaser,0.0,interp,seed);
+}
+
+
+NoiseBank *stdnoisebank(LISA *lisa,double *stproof,double *sdproof,double *stshot,double *sdshot,
+                        double *stlaser,double *sdlaser,unsigned long *seeds) {
+    double prebuffer[18], psd[18], exponent[18];
+
+    for(int k = 0; k < 6; k++) {
+        if(stproof[k] != stproof[0] || stshot[k] != stproof[0] || stlaser[k] != stproof[0])
+            return 0;
+
+        prebuffer[k] = pbtproof(lisa,stproof[k]);
+        psd[k] = sdproof[k];
+        exponent[k] = -2.0;
+
+        prebuffer[6 + k] = pbtshot(lisa,stshot[k]);
+        psd[6 + k] = sdshot[k];
+        exponent[6 + k] = 2.0;
+
+        prebuffer[12 + k] = pbtlaser(lisa,stlaser[k]);
+        psd[12 + k] = sdlaser[k];
+        exponent[12 + k] = 0.0;
+    }
 
-    return new PowerLawNoise(stlaser,pbtlaser,sdlaser,0.0,interp);
+    return new NoiseBank(18,stproof[0],prebuffer,psd,exponent,seeds);
 }
 
 
@@ -19,6 +19,11 @@ class TDInoise : public TDI {
     // set this to one if we are allocating noise objects
 
     int allocated;
+
+    // the parameter constructors generate their noises with a NoiseBank
+    // (if all sampling times are equal), and delete it with the noises
+
+    NoiseBank *bank;
     
  public:
     // Note: I label shot noises by sending and receiving spacecraft, not by link and receiving
@@ -56,6 +61,17 @@ class TDInoise : public TDI {
 
     void reset(unsigned long seed = 0);
 
+    // checkpoint all noises and LISA (shared noise objects, e.g. after
+    // lock, are saved more than once, which is harmless)
+
+    void savestate(FILE *file);
+    void loadstate(FILE *file);
+
+    // counters of all noises and LISA (shared noises are counted once)
+
+    void addcounters(EventCounters &counters);
+    void resetcounters();
+
     // basic TDI observables
 
     double y(int send, int link, int recv, int ret1, int ret2, int ret3, double t);
@@ -63,6 +79,40 @@ class TDInoise : public TDI {
 
     virtual double y(int send, int link, int recv, int ret1, int ret2, int ret3, int ret4, int ret5, int ret6, int ret7, double t);
     virtual double z(int send, int link, int recv, int ret1, int ret2, int ret3, int ret4, int ret5, int ret6, int ret7, int ret8, double t);
+    // table-driven combinations (see TDItable), for TDInoise proper
+
+    double yterm(const TDIstep &s, double t);
+    double zterm(const TDIstep &s, double t);
+
+    TDIobject *tableobject(const TDItable *table,int own = 0);
+
+    // between beginsample and endsample, the terms share the noise
+    // lookups at identical times (which recur across terms with the same
+    // delays, and across the X, Y, Z combinations)
+
+    void beginsample();
+    void endsample() { memoactive = 0; };
+
+ private:
+    struct memoentry {
+        Noise *noise;
+        double time, value;
+        long stamp;
+    };
+
+    static const int memosize = 512;
+
+    memoentry *memo;
+    long memostamp;
+    int memoactive;
+
+    double noisevalue(Noise *noise, double time);
+
+    double ynoise(int send, int link, int recv, int cyclic, double retardedtime);
+    double znoise(int recv, int cyclic, double retardedtime);
+
+    void setnoises(Noise *proofnoise[6],Noise *shotnoise[6],Noise *lasernoise[6]);
+    void stdnoises(double *stproof, double *sdproof, double *stshot, double *sdshot, double *stlaser, double *sdlaser);
 };
 
 
@@ -110,9 +160,18 @@ extern double lighttime(LISA *lisa);
 
 // standard Noise factories (should be static class members somewhere ???)
 
-extern Noise *stdproofnoise(LISA *lisa,double stproof,double sdproof,int interp = 1);
-extern Noise *stdopticalnoise(LISA *lisa,double stshot,double sdshot,int interp = 1);
-extern Noise *stdlasernoise(LISA *lisa,double stlaser,double sdlaser,int interp = 1);
+extern Noise *stdproofnoise(LISA *lisa,double stproof,double sdproof,int interp = 1,unsigned long seed = 0);
+extern Noise *stdopticalnoise(LISA *lisa,double stshot,double sdshot,int interp = 1,unsigned long seed = 0);
+extern Noise *stdlasernoise(LISA *lisa,double stlaser,double sdlaser,int interp = 1,unsigned long seed = 0);
+
+// the same 18 noises, generated together: the channels of the NoiseBank
+// are the proof-mass noises {1,1*,2,2*,3,3*}, the optical-path noises
+// {12,21,23,32,31,13}, and the laser noises {1,1*,2,2*,3,3*}, as in the
+// TDInoise constructors, seeded with seeds[0...17] (or with the global
+// seed, if seeds is null); returns 0 unless all the sampling times are equal
+
+extern NoiseBank *stdnoisebank(LISA *lisa,double *stproof,double *sdproof,double *stshot,double *sdshot,
+                               double *stlaser,double *sdlaser,unsigned long *seeds = 0);
 
 // ??? Why is the "extern" needed?
 
@@ -5,6 +5,10 @@
  */
 
 #include "lisasim-tdisignal.h"
+#include "lisasim-profile.h"
+
+#include <stdlib.h>
+#include <typeinfo>
 
 TDIsignal::TDIsignal(LISA *mylisa, WaveObject *mywave) {
     phlisa = mylisa->physlisa();
@@ -17,13 +21,38 @@ void TDIsignal::setphlisa(LISA *mylisa) {
     phlisa = mylisa;
 }
 
-void TDIsignal::reset() {
+void TDIsignal::reset(unsigned long seed) {
     lisa->reset();
 
     if(phlisa != lisa) phlisa->reset();
 }
 
+void TDIsignal::savestate(FILE *file) {
+    lisa->savestate(file);
+
+    if(phlisa != lisa) phlisa->savestate(file);
+}
+
+void TDIsignal::loadstate(FILE *file) {
+    lisa->loadstate(file);
+
+    if(phlisa != lisa) phlisa->loadstate(file);
+}
+
+void TDIsignal::addcounters(EventCounters &counters) {
+    lisa->getcounters(counters);
+    phlisa->getcounters(counters);
+}
+
+void TDIsignal::resetcounters() {
+    lisa->resetcounters();
+
+    if(phlisa != lisa) phlisa->resetcounters();
+}
+
 double TDIsignal::psi(Wave *nwave, Vector &lisan, double t) {
+    PROFILESTAGE(profilepsi);
+
     // check if the Wave is active at time t
     if(!nwave->inscope(t)) return 0.0;
 
@@ -82,6 +111,29 @@ double TDIsignal::y(int send, int slink, int recv, int ret1, int ret2, int ret3,
     if( (link == 3 && recv == 2) || (link == 1 && recv == 3) || (link == 2 && recv == 1) )
 	link = -link;
 
+    return ysignal(send,link,recv,retardedtime);
+}
+
+// table terms: same as y, but with the delays and the oriented link
+// worked out in advance, and without virtual calls
+
+double TDIsignal::yterm(const TDIstep &s, double t) {
+    lisa->newretardtime(t);
+    for(int k=0;k<s.delays;k++) lisa->retard(s.delay[k]);
+
+    return ysignal(s.send,s.olink,s.recv,lisa->retardedtime());
+}
+
+TDIobject *TDIsignal::tableobject(const TDItable *table,int own) {
+    if(typeid(*this) != typeid(TDIsignal))
+        return 0;
+
+    return new TDItableobject<TDIsignal>(this,table,own);
+}
+
+// the rest of y, with link oriented
+
+inline double TDIsignal::ysignal(int send, int link, int recv, double retardedtime) {
     // since the linkn returned by the "modern" versions of putn is oriented,
     // therefore the sign in denom is the same (-) for both positive and negative links
     // there's no problem in psi, because n is dotted twice into h
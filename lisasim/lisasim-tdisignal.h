@@ -25,9 +25,17 @@ class TDIsignal : public TDI {
 
     void setphlisa(LISA *mylisa);
 
-    // won't reset wave objects
+    // won't reset wave objects (seed is ignored)
 
-    void reset();
+    void reset(unsigned long seed = 0);
+
+    // same for checkpoints
+
+    void savestate(FILE *file);
+    void loadstate(FILE *file);
+
+    void addcounters(EventCounters &counters);
+    void resetcounters();
 
     // defined here only for comparison with the LISA simulator
 
@@ -39,6 +47,16 @@ class TDIsignal : public TDI {
     double y(int send, int link, int recv, int ret1, int ret2, int ret3, int ret4, int ret5, int ret6, int ret7, double t);
 
     double Phi(int slink,double t);
+
+    // table-driven combinations (see TDItable); z vanishes for signals
+
+    double yterm(const TDIstep &s, double t);
+    double zterm(const TDIstep &s, double t) { return 0.0; };
+
+    TDIobject *tableobject(const TDItable *table,int own = 0);
+
+ private:
+    double ysignal(int send, int link, int recv, double retardedtime);
 };
 
 #endif /* _LISASIM_TDISIGNAL_H_ */
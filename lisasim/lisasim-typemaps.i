@@ -143,6 +143,41 @@
 	Py_DECREF(arr);  /* Release our local copy of the PyArray */
 }
 
+// Same for an array of floats (for single-precision output)
+
+%typemap(in) (float* numarray, long length) {
+	PyArrayObject *arr;
+	
+	if (!PyArray_Check($input)) {
+		PyErr_SetString(PyExc_TypeError,"First argument is not an array");
+		return NULL;
+	}
+	
+	if (PyArray_ObjectType($input,0) != PyArray_FLOAT) {
+		PyErr_SetString(PyExc_TypeError, \
+			"Incorrect array type: we need an array of FLOAT");
+
+		return NULL;
+	}
+	
+	arr = PyArray_CONTIGUOUS((PyArrayObject *)$input);
+
+	if (arr->nd == 1) {
+		$1 = (float *)arr->data;
+		$2 = (long)arr->dimensions[0];
+	} else if (arr->nd == 2) {
+		$1 = (float *)arr->data;
+		$2 = (long)arr->dimensions[0] * (long)arr->dimensions[1];
+	} else {
+		PyErr_SetString(PyExc_TypeError, \
+			"Incorrect number of dims: we want a 1D or 2D array");
+
+		return NULL;
+	}
+	
+	Py_DECREF(arr);  /* Release our local copy of the PyArray */
+}
+
 // Map a Python sequence into an array of doubles;
 // pass also the number of elements
 
@@ -276,6 +311,227 @@
    delete [] $1;
 }
 
+// convert a list of LISA objects (e.g., one per thread)
+
+%typemap(in) (LISA **thelisas, int lisas) {
+  int i;
+
+  // check that we are really getting a sequence (list or tuple)
+
+  if (!PySequence_Check($input)) {
+      PyErr_SetString(PyExc_TypeError,"Expecting a sequence");
+      return NULL;
+  }
+
+  int dim = PySequence_Size($input);
+  LISA **temp = new LISA*[dim];
+
+  // convert each element
+
+  for (i = 0; i < dim; i++) {
+      PyObject *o = PySequence_GetItem($input,i);
+
+      SWIG_ConvertPtr(o, (void **)&temp[i], $descriptor(LISA *), SWIG_POINTER_EXCEPTION);
+  }
+
+  // return pointer to the array
+
+  $1 = temp;
+  $2 = dim;
+}
+
+%typemap(freearg) (LISA **thelisas, int lisas)  {
+   delete [] $1;
+}
+
+// convert a list of strings (the char pointers stay valid only as long
+// as the Python strings do)
+
+%typemap(in) (char **thenames, int names) {
+  int i;
+
+  // check that we are really getting a sequence (list or tuple)
+
+  if (!PySequence_Check($input)) {
+      PyErr_SetString(PyExc_TypeError,"Expecting a sequence");
+      return NULL;
+  }
+
+  int dim = PySequence_Size($input);
+  char **temp = new char*[dim];
+
+  // convert each element
+
+  for (i = 0; i < dim; i++) {
+      PyObject *o = PySequence_GetItem($input,i);
+
+      if(!PyString_Check(o)) {
+         delete [] temp;
+         PyErr_SetString(PyExc_TypeError,"Expecting a sequence of strings");
+         return NULL;
+      }
+
+      temp[i] = PyString_AsString(o);
+      Py_DECREF(o);
+  }
+
+  // return pointer to the array
+
+  $1 = temp;
+  $2 = dim;
+}
+
+%typemap(freearg) (char **thenames, int names)  {
+   delete [] $1;
+}
+
+// convert a list of (nonnegative) integer seeds
+
+%typemap(in) (unsigned long *theseeds, int seeds) {
+  int i;
+
+  // check that we are really getting a sequence (list or tuple)
+
+  if (!PySequence_Check($input)) {
+      PyErr_SetString(PyExc_TypeError,"Expecting a sequence");
+      return NULL;
+  }
+
+  int dim = PySequence_Size($input);
+  unsigned long *temp = new unsigned long[dim];
+
+  // convert each element
+
+  for (i = 0; i < dim; i++) {
+      PyObject *o = PySequence_GetItem($input,i);
+
+      temp[i] = PyLong_AsUnsignedLong(o);
+      Py_DECREF(o);
+
+      if(PyErr_Occurred()) {
+         delete [] temp;
+         PyErr_SetString(PyExc_ValueError,"Expecting a sequence of nonnegative integers");
+         return NULL;
+      }
+  }
+
+  // return pointer to the array
+
+  $1 = temp;
+  $2 = dim;
+}
+
+%typemap(freearg) (unsigned long *theseeds, int seeds)  {
+   delete [] $1;
+}
+
+// convert a list of integers (e.g., group sizes)
+
+%typemap(in) (int *theints, int ints) {
+  int i;
+
+  // check that we are really getting a sequence (list or tuple)
+
+  if (!PySequence_Check($input)) {
+      PyErr_SetString(PyExc_TypeError,"Expecting a sequence");
+      return NULL;
+  }
+
+  int dim = PySequence_Size($input);
+  int *temp = new int[dim];
+
+  // convert each element
+
+  for (i = 0; i < dim; i++) {
+      PyObject *o = PySequence_GetItem($input,i);
+
+      temp[i] = (int)PyInt_AsLong(o);
+      Py_DECREF(o);
+
+      if(PyErr_Occurred()) {
+         delete [] temp;
+         PyErr_SetString(PyExc_ValueError,"Expecting a sequence of integers");
+         return NULL;
+      }
+  }
+
+  // return pointer to the array
+
+  $1 = temp;
+  $2 = dim;
+}
+
+%typemap(freearg) (int *theints, int ints)  {
+   delete [] $1;
+}
+
+// convert a list of TDI terms (coefficient,'y' or 'z',send,link,recv,delays),
+// where delays is a sequence of at most 8 integers (ret1, ret2, ...)
+
+%typemap(in) (const TDIterm *theterms, int terms) {
+  int i;
+
+  if (!PySequence_Check($input)) {
+      PyErr_SetString(PyExc_TypeError,"Expecting a sequence");
+      return NULL;
+  }
+
+  int dim = PySequence_Size($input);
+  TDIterm *temp = new TDIterm[dim > 0 ? dim : 1];
+
+  for (i = 0; i < dim; i++) {
+      PyObject *o = PySequence_GetItem($input,i);
+
+      double scale;
+      char *kind;
+      int send, link, recv;
+      PyObject *delays = 0;
+
+      int ok = PyTuple_Check(o) && PyArg_ParseTuple(o,"dsiii|O",&scale,&kind,&send,&link,&recv,&delays);
+      Py_DECREF(o);
+
+      if(ok && delays && (!PySequence_Check(delays) || PySequence_Size(delays) > 8))
+          ok = 0;
+
+      if(!ok) {
+         delete [] temp;
+         PyErr_SetString(PyExc_ValueError,"Expecting a sequence of tuples (coefficient,'y' or 'z',send,link,recv,(ret1,ret2,...))");
+         return NULL;
+      }
+
+      TDIterm &term = temp[i];
+
+      term.scale = scale; term.block = 1; term.sign = 1;
+      term.kind = kind[0] && !kind[1] ? kind[0] : '?';
+      term.send = send; term.link = link; term.recv = recv;
+
+      for (int r = 0; r < 8; r++)
+          term.ret[r] = 0;
+
+      int rets = delays ? PySequence_Size(delays) : 0;
+
+      for (int r = 0; r < rets; r++) {
+          PyObject *d = PySequence_GetItem(delays,r);
+
+          term.ret[r] = (int)PyInt_AsLong(d);
+          Py_DECREF(d);
+      }
+
+      if(PyErr_Occurred()) {
+         delete [] temp;
+         PyErr_SetString(PyExc_ValueError,"Expecting integer delays");
+         return NULL;
+      }
+  }
+
+  $1 = temp;
+  $2 = dim;
+}
+
+%typemap(freearg) (const TDIterm *theterms, int terms)  {
+   delete [] $1;
+}
+
 // from the SWIG documentation: input a python function
 
 %typemap(in) PyObject* PYTHONFUNC {
@@ -16,5 +16,7 @@
 #include "lisasim-retard.h"
 #include "lisasim-signal.h"
 #include "lisasim-except.h"
+#include "lisasim-parallel.h"
+#include "lisasim-profile.h"
 
 #endif /* _LISASIM_H_ */
@@ -219,25 +219,34 @@ def checkobs(observables):
             
     return retobs
 
-def getobsc(snum,stime,observables,zerotime=0.0,forcepython=0):
-    return getobs(snum,stime,observables,zerotime,display=1,forcepython=forcepython)
+# getobs and getobsc return arrays of doubles, or (with dtype='f') of
+# single-precision floats; the observables are always computed in double
+# precision
+
+def getobsc(snum,stime,observables,zerotime=0.0,forcepython=0,dtype='d'):
+    return getobs(snum,stime,observables,zerotime,display=1,forcepython=forcepython,dtype=dtype)
+
+def fastgetobstyped(array,snum,stime,obsobj,zerotime,display):
+    if array.dtype.char == 'f':
+        lisaswig.fastgetobsf(array,snum,stime,obsobj,zerotime,0,display)
+    elif display:
+        lisaswig.fastgetobsc(array,snum,stime,obsobj,zerotime)
+    else:
+        lisaswig.fastgetobs(array,snum,stime,obsobj,zerotime)
 
-def getobs(snum,stime,observables,zerotime=0.0,display=0,forcepython=0):
+def getobs(snum,stime,observables,zerotime=0.0,display=0,forcepython=0,dtype='d'):
     if len(numpy.shape(observables)) == 0:
         obsobj = checkobs([observables])
                 
         if obsobj and (not forcepython):
-            array = numpy.zeros(snum,dtype='d')
+            array = numpy.zeros(snum,dtype=dtype)
 
-            if display:
-                lisaswig.fastgetobsc(array,snum,stime,obsobj,zerotime)
-            else:
-                lisaswig.fastgetobs(array,snum,stime,obsobj,zerotime)
+            fastgetobstyped(array,snum,stime,obsobj,zerotime,display)
         else:
             if display:
-                return getobscount(snum,stime,observables,zerotime)
+                return getobscount(snum,stime,observables,zerotime,dtype)
             else:
-                array = numpy.zeros(snum,dtype='d')
+                array = numpy.zeros(snum,dtype=dtype)
             
                 for i in numpy.arange(0,snum):
                     array[i] = observables(zerotime+i*stime)
@@ -246,24 +255,489 @@ def getobs(snum,stime,observables,zerotime=0.0,display=0,forcepython=0):
 
         if obsobj and (not forcepython):
             obslen = numpy.shape(observables)[0]
-            array = numpy.zeros((snum,obslen),dtype='d')
+            array = numpy.zeros((snum,obslen),dtype=dtype)
 
-            if display:
-                lisaswig.fastgetobsc(array,snum,stime,obsobj,zerotime)
-            else:
-                lisaswig.fastgetobs(array,snum,stime,obsobj,zerotime)
+            fastgetobstyped(array,snum,stime,obsobj,zerotime,display)
         else:
             if display:
-                return getobscount(snum,stime,observables,zerotime)
+                return getobscount(snum,stime,observables,zerotime,dtype)
             else:
                 obslen = numpy.shape(observables)[0]
-                array = numpy.zeros((snum,obslen),dtype='d')
+                array = numpy.zeros((snum,obslen),dtype=dtype)
             
                 for i in numpy.arange(0,snum):
                     for j in xrange(0,obslen):
                         array[i,j] = observables[j](zerotime+i*stime)
     return array
 
+# getobs at arbitrary (sorted) times, given as a sequence or numpy array
+
+def getobstimes(times,observables,forcepython=0):
+    times = numpy.asarray(times,dtype='d')
+    snum = len(times)
+
+    if numpy.any(times[1:] < times[:-1]):
+        raise ValueError, "getobstimes(): times must be sorted"
+
+    if len(numpy.shape(observables)) == 0:
+        obsobj = checkobs([observables])
+        array = numpy.zeros(snum,dtype='d')
+    else:
+        obsobj = checkobs(observables)
+        obslen = numpy.shape(observables)[0]
+        array = numpy.zeros((snum,obslen),dtype='d')
+
+    if obsobj and (not forcepython):
+        lisaswig.fastgetobstimes(array,times,obsobj)
+    elif len(numpy.shape(observables)) == 0:
+        for i in xrange(0,snum):
+            array[i] = observables(times[i])
+    else:
+        for i in xrange(0,snum):
+            for j in xrange(0,obslen):
+                array[i,j] = observables[j](times[i])
+
+    return array
+
+# decimated getobs: snum samples at cadence decimation*stime, computed
+# from the observables at cadence stime, filtered with the FIR filter fir
+# (by default lowpassfir(decimation)) without storing the full-rate series;
+# the observables are evaluated from zerotime on, so the first sample is
+# centered on zerotime + (len(fir)-1)/2 * stime
+
+def getobsdec(snum,stime,observables,decimation,fir=None,zerotime=0.0):
+    if fir == None:
+        fir = lowpassfir(decimation)
+
+    if len(numpy.shape(observables)) == 0:
+        obsobj = checkobs([observables])
+        array = numpy.zeros(snum,dtype='d')
+    else:
+        obsobj = checkobs(observables)
+        array = numpy.zeros((snum,numpy.shape(observables)[0]),dtype='d')
+
+    if not obsobj:
+        raise NotImplementedError, "getobsdec(): can only handle native TDI observables"
+
+    lisaswig.fastgetobsdec(array,snum,stime,obsobj,zerotime,decimation,fir)
+
+    return array
+
+# a Blackman-windowed sinc low-pass filter, with cutoff at the Nyquist
+# frequency of the decimated series and unit DC gain; taps is odd, so that
+# the filter introduces no delay
+
+def lowpassfir(decimation,taps=None):
+    if taps == None:
+        taps = 8 * decimation + 1
+    elif taps % 2 == 0:
+        taps = taps + 1
+
+    n = numpy.arange(taps) - (taps - 1) / 2
+    
+    fir = numpy.sinc(n / float(decimation)) * numpy.blackman(taps)
+    
+    return fir / numpy.sum(fir)
+
+# chunked getobs: a generator that yields successive arrays of (at most)
+# chunk rows, for a total of snum rows (or forever, if snum is None);
+# each chunk continues from the state left by the previous one, e.g.
+#
+#   for data in getobsiter(65536,1.0,[tdi.X,tdi.Y,tdi.Z],snum=2**22):
+#       ...
+#
+# note that the arrays are not reused, so they can be kept by the caller
+
+def getobsiter(chunk,stime,observables,zerotime=0.0,snum=None,dtype='d'):
+    if len(numpy.shape(observables)) == 0:
+        obsobj = checkobs([observables])
+        obslen = 0
+    else:
+        obsobj = checkobs(observables)
+        obslen = numpy.shape(observables)[0]
+
+    offset = 0
+
+    while snum == None or offset < snum:
+        if snum == None:
+            rows = chunk
+        else:
+            rows = min(chunk,snum - offset)
+
+        if obslen == 0:
+            array = numpy.zeros(rows,dtype=dtype)
+        else:
+            array = numpy.zeros((rows,obslen),dtype=dtype)
+
+        if obsobj and dtype == 'f':
+            lisaswig.fastgetobsf(array,rows,stime,obsobj,zerotime,offset)
+        elif obsobj:
+            lisaswig.fastgetobschunk(array,rows,stime,obsobj,zerotime,offset)
+        else:
+            for i in xrange(0,rows):
+                t = zerotime + (offset + i) * stime
+            
+                if obslen == 0:
+                    array[i] = observables(t)
+                else:
+                    for j in xrange(0,obslen):
+                        array[i,j] = observables[j](t)
+
+        offset += rows
+
+        yield array
+
+# streaming getobs: write the observables to filename (as native-endian
+# doubles, or floats with dtype='f', one row per time, as in lisaXML Binary
+# streams) instead of returning an array; memory use does not grow with
+# snum. The file can be read back with readbinary, or referenced from
+# lisaXML.TDIData by name
+
+def getobsfile(filename,snum,stime,observables,zerotime=0.0,display=0,append=0,dtype='d'):
+    if len(numpy.shape(observables)) == 0:
+        observables = [observables]
+
+    obsobj = checkobs(observables)
+
+    if obsobj:
+        lisaswig.fastgetobsfile(filename,snum,stime,obsobj,zerotime,display,append,dtype == 'f')
+    else:
+        obslen = len(observables)
+    
+        if append:
+            file = open(filename,'ab')
+        else:
+            file = open(filename,'wb')
+
+        for mini in xrange(0,snum,16384):
+            maxi = min(mini + 16384,snum)
+            
+            array = numpy.zeros((maxi-mini,obslen),dtype=dtype)
+
+            for i in xrange(mini,maxi):
+                for j in xrange(0,obslen):
+                    array[i-mini,j] = observables[j](zerotime+i*stime)
+
+            file.write(array.tostring())
+
+        file.close()
+
+# checkpointed getobsfile for long runs: after every "every" batches of
+# 16384 rows, the state of tdi (the TDI object behind all the observables)
+# and the number of rows written are saved to checkfile. If checkfile
+# exists when getobscheckpoint is called, tdi (which must be built exactly
+# as in the interrupted run) is restored from it, filename is truncated
+# to the rows it covers, and the run continues from there, producing the
+# same file as an uninterrupted run. checkfile is removed at the end.
+
+import os
+
+def getobscheckpoint(filename,checkfile,snum,stime,tdi,observables,zerotime=0.0,every=64,display=0,dtype='d'):
+    if len(numpy.shape(observables)) == 0:
+        observables = [observables]
+
+    obsobj = checkobs(observables)
+
+    if not obsobj:
+        raise NotImplementedError, "getobscheckpoint(): can only handle native TDI observables"
+
+    rowbytes = len(observables) * numpy.dtype(dtype).itemsize
+
+    if os.path.exists(checkfile):
+        offset = lisaswig.loadcheckpoint(checkfile,tdi)
+
+        # the data file must hold at least the rows the checkpoint covers;
+        # truncate would otherwise pad it with zeros
+
+        if not os.path.exists(filename) or os.path.getsize(filename) < offset * rowbytes:
+            raise IOError, "getobscheckpoint(): %s is shorter than the %d rows saved in %s" % (filename,offset,checkfile)
+
+        file = open(filename,'r+b')
+        file.truncate(offset * rowbytes)
+        file.close()
+    else:
+        offset = 0
+        open(filename,'wb').close()
+
+    while offset < snum:
+        rows = min(every * 16384,snum - offset)
+
+        lisaswig.fastgetobsfile(filename,rows,stime,obsobj,zerotime,display,1,dtype == 'f',offset)
+        offset += rows
+
+        if offset < snum:
+            # make the rows durable before the checkpoint that counts them
+
+            fd = os.open(filename,os.O_RDWR)
+            try:
+                os.fsync(fd)
+            finally:
+                os.close(fd)
+
+            lisaswig.savecheckpoint(checkfile,tdi,offset)
+
+    if os.path.exists(checkfile):
+        os.remove(checkfile)
+
+# time-sharded generation: getobsshard computes rows snum*shard/shards ...
+# snum*(shard+1)/shards - 1 of a run of snum rows, and writes them to
+# filename (after a 64-byte header, see below); mergeshards checks a
+# complete set of shard files and joins them into a plain binary file.
+# Every shard must build its observables exactly as the serial run would
+# (same LISA, same noise seeds); the buffered noises then regenerate
+# their own history from sample zero, so that the shards concatenate
+# exactly into the serial result. The optional warmup (in rows, see
+# shardwarmup) is evaluated and discarded before the first row.
+
+shardmagic = 'SLSHARD1'
+
+def shardrange(shard,shards,snum):
+    return (snum * shard) / shards, (snum * (shard + 1)) / shards
+
+# warm-up covering the noise prebuffer used by stdproofnoise and
+# stdlasernoise (8 lighttimes plus two noise samples)
+
+def shardwarmup(lisa,stime,noisestime=None):
+    if noisestime == None:
+        noisestime = stime
+
+    lighttime = 1.10 * max(lisa.armlength(1,0.0),lisa.armlength(2,0.0),lisa.armlength(3,0.0))
+
+    return int(math.ceil((8.0 * lighttime + 2.0 * noisestime) / stime))
+
+def getobsshard(filename,shard,shards,snum,stime,observables,zerotime=0.0,warmup=0,display=0,dtype='d'):
+    if len(numpy.shape(observables)) == 0:
+        observables = [observables]
+
+    obsobj = checkobs(observables)
+
+    if not obsobj:
+        raise NotImplementedError, "getobsshard(): can only handle native TDI observables"
+
+    obslen = len(observables)
+    mini, maxi = shardrange(shard,shards,snum)
+
+    # warm up, in chunks
+
+    for chunk in xrange(max(mini - warmup,0),mini,16384):
+        rows = min(16384,mini - chunk)
+        lisaswig.fastgetobschunk(numpy.zeros((rows,obslen),dtype='d'),rows,stime,obsobj,zerotime,chunk)
+
+    file = open(filename,'wb')
+
+    file.write(shardmagic)
+    file.write(numpy.array([shard,shards,mini,maxi,obslen],dtype='int64').tostring())
+    file.write(numpy.array([stime,zerotime],dtype='d').tostring())
+    file.flush()
+
+    try:
+        lisaswig.fastgetobsfd(file.fileno(),maxi - mini,stime,obsobj,zerotime,display,dtype == 'f',mini)
+    finally:
+        file.close()
+
+def readshardheader(filename):
+    file = open(filename,'rb')
+    header = file.read(64)
+    file.close()
+
+    if len(header) != 64 or header[0:8] != shardmagic:
+        raise IOError, "readshardheader(): %s is not a shard file" % filename
+
+    shard, shards, mini, maxi, columns = map(int,numpy.fromstring(header[8:48],'int64'))
+    stime, zerotime = numpy.fromstring(header[48:64],'d')
+
+    return {'shard': shard, 'shards': shards, 'mini': mini, 'maxi': maxi,
+            'columns': columns, 'stime': stime, 'zerotime': zerotime}
+
+# returns (rows,columns,dtype) of the merged file
+
+def mergeshards(outfile,shardfiles):
+    headers = [readshardheader(shardfile) for shardfile in shardfiles]
+
+    for header,shardfile in zip(headers,shardfiles):
+        header['file'] = shardfile
+
+    headers.sort(key = lambda h: h['shard'])
+
+    shards = headers[0]['shards']
+    first = headers[0]
+
+    if [h['shard'] for h in headers] != range(0,shards):
+        raise ValueError, "mergeshards(): need exactly one file for each of %d shards" % shards
+
+    itemsize = None
+    
+    for i in range(0,shards):
+        h = headers[i]
+
+        for key in ('shards','columns','stime','zerotime'):
+            if h[key] != first[key]:
+                raise ValueError, "mergeshards(): %s has inconsistent %s" % (h['file'],key)
+
+        if (i == 0 and h['mini'] != 0) or (i > 0 and h['mini'] != headers[i-1]['maxi']):
+            raise ValueError, "mergeshards(): %s does not continue the previous shard" % h['file']
+
+        datasize = os.path.getsize(h['file']) - 64
+        values = (h['maxi'] - h['mini']) * h['columns']
+
+        if values > 0:
+            if datasize % values != 0 or not datasize / values in (4,8):
+                raise ValueError, "mergeshards(): %s is truncated" % h['file']
+
+            if itemsize == None:
+                itemsize = datasize / values
+            elif itemsize != datasize / values:
+                raise ValueError, "mergeshards(): %s has inconsistent precision" % h['file']
+
+    out = open(outfile,'wb')
+
+    for h in headers:
+        file = open(h['file'],'rb')
+        file.seek(64)
+
+        while True:
+            block = file.read(8 * 16384 * h['columns'])
+            if not block:
+                break
+            out.write(block)
+
+        file.close()
+
+    out.close()
+
+    return headers[-1]['maxi'], first['columns'], itemsize == 4 and 'f' or 'd'
+
+# profiling: turn on with setprofile(1) (needs setup.py --with-profile),
+# run the simulation, then getprofile() returns a dictionary
+# {stage: (calls,seconds)}, which can be saved with json.dump
+
+def getprofile():
+    profile = {}
+
+    for stage in range(0,lisaswig.profilestages):
+        profile[lisaswig.profilename(stage)] = (lisaswig.profilecalls(stage),lisaswig.profiletime(stage))
+
+    return profile
+
+# parallel getobs; factory() must return a new set of observables
+# (a Signal or TDI method, or a list of them) built on its own LISA,
+# Noise, and TDI objects each time it is called. The time range is
+# split among "threads" replicas; the pseudorandom seed state is
+# restored before each call to factory(), so that self-seeded noises
+# come out identical in all replicas (explicit seeds work too)
+
+import random
+
+# build count replicas with factory() (see getobspar); returns the
+# replicas (to hold on to, since checkobs may create new TDIobjects),
+# the flat list of their native observables, and the number of
+# observables per replica (0 if factory() returns a single one)
+
+def makereplicas(factory,count,caller):
+    # make sure the seed sequences are initialized before saving them
+
+    lisaswig.getglobalseed()
+
+    pystate, pyseeds = random.getstate(), lisaswig.cseeds[:]
+    cseed = lisaswig.WhiteNoiseSource.getglobalseed()
+
+    replicas, obsobj = [], []
+
+    for r in xrange(count):
+        random.setstate(pystate)
+        lisaswig.cseeds[:] = pyseeds
+        lisaswig.WhiteNoiseSource.setglobalseed(cseed)
+
+        replica = factory()
+
+        if len(numpy.shape(replica)) == 0:
+            obslen, checked = 0, checkobs([replica])
+        else:
+            obslen, checked = len(replica), checkobs(replica)
+
+        if not checked:
+            raise TypeError, "lisautils::%s: factory() must return native Signal objects or TDI methods." % caller
+
+        replicas.append(replica)
+        obsobj.extend(checked)
+
+    return replicas, obsobj, obslen
+
+def getobspar(snum,stime,factory,threads=0,zerotime=0.0,warmup=0):
+    if threads <= 0:
+        import multiprocessing
+        threads = multiprocessing.cpu_count()
+
+    threads = max(1,min(threads,snum))
+
+    replicas, obsobj, obslen = makereplicas(factory,threads,'getobspar')
+
+    if obslen == 0:
+        array = numpy.zeros(snum,dtype='d')
+    else:
+        array = numpy.zeros((snum,obslen),dtype='d')
+
+    lisaswig.fastgetobspar(array,snum,stime,obsobj,threads,zerotime,warmup)
+
+    return array
+
+# scheduled getobspar, for observables of very different cost: factory()
+# returns a list of observables, divided into consecutive groups of sizes
+# groups (e.g., [3,2] for X1,X2,X3 of a TDIsignal followed by two TDInoise
+# observables); different groups must not share LISA, Noise, or TDI
+# objects. Each group is split among "replicas" replicas (default: twice
+# the threads), and (group,chunk) tasks are balanced among the threads by
+# work stealing. Returns the array of observables, and an array of shape
+# (len(groups),chunks) with the time (in seconds) spent on each task
+
+def getobssched(snum,stime,factory,groups,threads=0,replicas=0,zerotime=0.0,chunk=16384,warmup=0):
+    if threads <= 0:
+        import multiprocessing
+        threads = multiprocessing.cpu_count()
+
+    if replicas <= 0:
+        replicas = 2 * threads
+
+    chunks = (snum + chunk - 1) / chunk
+    replicas = max(1,min(replicas,chunks))
+
+    held, obsobj, obslen = makereplicas(factory,replicas,'getobssched')
+
+    if obslen != sum(groups):
+        raise TypeError, "lisautils::getobssched: groups must add up to the number of observables returned by factory()."
+
+    array = numpy.zeros((snum,obslen),dtype='d')
+    costs = numpy.zeros((len(groups),chunks),dtype='d')
+
+    lisaswig.fastgetobssched(array,snum,stime,obsobj,replicas,list(groups),costs,threads,zerotime,chunk,warmup)
+
+    return array, costs
+
+# Monte Carlo noise ensembles: one TDInoise realization for each seed in
+# seeds, with standard noises of parameters noise = (PMdt,PMpsd,SHdt,SHpsd,
+# LSdt,LSpsd), run on "threads" threads; lisafactory() must return a new
+# LISA object each time it is called (one is needed for every thread).
+# Returns an array of shape (len(seeds),snum,len(observables)) and an
+# array with the throughput of each realization (samples/s)
+
+def getensemble(snum,stime,lisafactory,seeds,observables=('X1','X2','X3'),
+                noise=(1.0,2.5e-48,1.0,1.8e-37,1.0,1.1e-26),threads=0,zerotime=0.0,interp=1):
+    if threads <= 0:
+        import multiprocessing
+        threads = multiprocessing.cpu_count()
+
+    threads = max(1,min(threads,len(seeds)))
+
+    lisas = [lisafactory() for i in xrange(threads)]
+
+    array = numpy.zeros((len(seeds),snum,len(observables)),dtype='d')
+    rates = numpy.zeros(len(seeds),dtype='d')
+
+    lisaswig.fastgetensemble(array,snum,stime,lisas,list(observables),list(seeds),rates,
+                             list(noise),interp,zerotime)
+
+    return array, rates
+
 # used by getobsc (hoping time.time() will work on all platforms...)
 
 import sys
@@ -290,7 +764,7 @@ def dotime(i,snum,inittime,lasttime):
 
 # the next version, getobsc, will display a countdown to completion
 
-def getobscount(snum,stime,observables,zerotime=0.0):
+def getobscount(snum,stime,observables,zerotime=0.0,dtype='d'):
     fullinittime = time()
     inittime = int(fullinittime)
     lasttime = 0
@@ -300,14 +774,14 @@ def getobscount(snum,stime,observables,zerotime=0.0):
 
     try:
         if len(numpy.shape(observables)) == 0:
-            array = numpy.zeros(snum,dtype='d')
+            array = numpy.zeros(snum,dtype=dtype)
             for i in numpy.arange(0,snum):
                 array[i] = observables(zerotime+i*stime)
                 if i % 1024 == 0:
                     lasttime = dotime(i,snum,inittime,lasttime)
         else:
             obslen = numpy.shape(observables)[0]
-            array = numpy.zeros((snum,obslen),dtype='d')
+            array = numpy.zeros((snum,obslen),dtype=dtype)
             for i in numpy.arange(0,snum):
                 for j in xrange(0,obslen):
                     array[i,j] = observables[j](zerotime+i*stime)
@@ -401,9 +875,9 @@ def writebinary(filename,a,append=0):
 
 # in a future version, this should also get the length from the file
 
-def readbinary(filename,length):
+def readbinary(filename,length,dtype='d'):
     file = open(filename,'r')
-    buffer = numpy.fromstring(file.read(length*8),'double')
+    buffer = numpy.fromstring(file.read(length*numpy.dtype(dtype).itemsize),dtype)
     file.close()
     # then reshape the buffer if needed
     return buffer
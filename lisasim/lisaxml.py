@@ -691,7 +691,7 @@ class lisaXML(writeXML):
             self.theNoiseData.append(self.ProcessObjectData(object,name,comments))
 
 
-    def TDIData(self,data,length,cadence,description,offset=0,encoding='Binary',comments=''):
+    def TDIData(self,data,length,cadence,description,offset=0,encoding='Binary',comments='',dtype='d'):
         """Add a TimeSeries object to a lisaXML file object. Here
         'data' is the numpy array containing the time series
         (simultaneous entries on the same row); 'length' is the desired
@@ -703,7 +703,13 @@ class lisaXML(writeXML):
         in a separate binary file, or 'Text' for inline storage in the
         XML file; 'comments' is added to the TimeSeries entry. To
         skip some records at the beginning of the array, use a slicing
-        syntax such as data[1:].
+        syntax such as data[1:]. For very long series, 'data' can
+        also be the name of a binary file written by
+        lisautils.getobsfile, with as many columns as there are
+        entries in 'description'; it is copied in blocks, without
+        loading it in memory (Binary encoding only). Arrays (or data
+        files, with dtype='f') of single-precision floats are written
+        as float32 Binary streams, with Encoding 'Binary,...,Float32'.
         
         Each lisaXML file can contain several TimeSeries objects,
         all contained in the TDIData block; if binary storage is
@@ -716,25 +722,24 @@ class lisaXML(writeXML):
         # Should use different names for phase and frequency TDI variables
 
         TimeSeries = typeTimeSeries()
-        
-        try:
+
+        if isinstance(data,str):
+            if not 'Binary' in encoding:
+                print "lisaXML::TDIData: data files can only be written with Binary encoding"
+                raise NotImplementedError
+
+            try:
+                TimeSeries.records = len(string.split(description,','))
+                TimeSeries.alength = os.path.getsize(data) / (numpy.dtype(dtype).itemsize * TimeSeries.records)
+            except:
+                print "lisaXML::TDIData: cannot access data file " + data
+                raise IOError
+
             TimeSeries.data = data
-            TimeSeries.dim = len(numpy.shape(data))
-            TimeSeries.alength = numpy.shape(data)[0]
-            
-            if data.dtype.char != 'd':
-                raise TypeError
-        except:
-            print "lisaXML::TDIData: data must be a proper numpy array of doubles"
-            raise TypeError
-        
-        if TimeSeries.dim == 1:
-            TimeSeries.records = 1
-        elif TimeSeries.dim == 2:        
-            TimeSeries.records = numpy.shape(data)[1]
+            TimeSeries.dim = 2
+            TimeSeries.dtype = dtype
         else:
-            print "lisaXML::TDIData: behavior undetermined for arrays of this dimension"
-            raise NotImplementedError
+            self.TDIDataArray(TimeSeries,data)
 
         TimeSeries.length = length
 
@@ -755,8 +760,32 @@ class lisaXML(writeXML):
    
         self.theTDIData.append(TimeSeries)
 
-    def writearray(self,data,length,records,description,encoding):
-        self.opentag('Array',{'Name': description,'Type': 'double'})
+    def TDIDataArray(self,TimeSeries,data):
+        try:
+            TimeSeries.data = data
+            TimeSeries.dim = len(numpy.shape(data))
+            TimeSeries.alength = numpy.shape(data)[0]
+            TimeSeries.dtype = data.dtype.char
+            
+            if not data.dtype.char in ('d','f'):
+                raise TypeError
+        except:
+            print "lisaXML::TDIData: data must be a proper numpy array of doubles (or floats)"
+            raise TypeError
+        
+        if TimeSeries.dim == 1:
+            TimeSeries.records = 1
+        elif TimeSeries.dim == 2:        
+            TimeSeries.records = numpy.shape(data)[1]
+        else:
+            print "lisaXML::TDIData: behavior undetermined for arrays of this dimension"
+            raise NotImplementedError
+
+    def writearray(self,data,length,records,description,encoding,dtype='d'):
+        if dtype == 'f':
+            self.opentag('Array',{'Name': description,'Type': 'float'})
+        else:
+            self.opentag('Array',{'Name': description,'Type': 'double'})
         
         self.coupletag('Dim',{'Name': 'Length'},length)        
         self.coupletag('Dim',{'Name': 'Records'},records)
@@ -774,6 +803,9 @@ class lisaXML(writeXML):
                 print 'lisaXML::writedata: cannot determine binary encoding'
                 raise NotImplementedError
 
+            if dtype == 'f':
+                encoding += ',Float32'
+
             # defaulting to remote storage
             # determine binary filename (base filename + ordinal + '.bin')
 
@@ -786,7 +818,22 @@ class lisaXML(writeXML):
 
             bfile = open(binaryfilename, 'w')
 
-            if len(data) != length:
+            if isinstance(data,str):
+                # copy the first length rows of a data file, a block at a time
+                
+                dfile = open(data,'rb')
+                
+                itemsize = numpy.dtype(dtype).itemsize
+                left = itemsize * length * records
+                while left > 0:
+                    block = dfile.read(min(left,itemsize*16384*records))
+                    if not block:
+                        break
+                    bfile.write(block)
+                    left -= len(block)
+                
+                dfile.close()
+            elif len(data) != length:
                 bfile.write(data[0:length].tostring())
             else:
                 bfile.write(data.tostring())
@@ -835,7 +882,8 @@ class lisaXML(writeXML):
                         TimeSeries.length,
                         TimeSeries.records,
                         TimeSeries.description,
-                        TimeSeries.encoding)
+                        TimeSeries.encoding,
+                        TimeSeries.dtype)
        
         self.closetag('XSIL')
 
@@ -1097,6 +1145,11 @@ class readXML:
             elif node2.tagName == 'Param':
                 timeseries[node2.Name] = self.getParam(node2)
             elif node2.tagName == 'Array':
+                try:
+                    arraytype = node2.Type
+                except AttributeError:
+                    arraytype = 'double'
+            
                 for node3 in node2:
                     if node3.tagName == 'Dim':
                         timeseries[node3.Name] = self.getDim(node3)
@@ -1107,8 +1160,13 @@ class readXML:
                             timeseries['Filename'] = str(node3)
                             
                             if 'Binary' in timeseries['Encoding']:
-                                # assume length of doubles is 8 (generic?)
-                                readlength = 8*timeseries['Length']*timeseries['Records']
+                                # float32 streams are marked in the encoding (and array type)
+                                if 'Float32' in timeseries['Encoding'] or arraytype == 'float':
+                                    datatype = 'float32'
+                                else:
+                                    datatype = 'double'
+                            
+                                readlength = numpy.dtype(datatype).itemsize*timeseries['Length']*timeseries['Records']
     
                                 # need to catch reading errors here
                                 if self.directory:
@@ -1116,7 +1174,7 @@ class readXML:
                                 else: 
                                     binaryfile = open(timeseries['Filename'],'r')
                                                             
-                                readbuffer = numpy.fromstring(binaryfile.read(readlength),'double')
+                                readbuffer = numpy.fromstring(binaryfile.read(readlength),datatype)
                                 binaryfile.close()
                 
                                 if (('BigEndian' in timeseries['Encoding'] and sys.byteorder == 'little') or
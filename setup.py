@@ -29,6 +29,8 @@ numpy_prefix = ''
 swig_bin = 'swig'
 gsl_prefix = ''
 make_clib = False
+make_profile = False
+make_driver = False
 
 # At the moment, this setup script does not deal with --home.
 # I should also modify the --help text to discuss these options
@@ -47,6 +49,12 @@ for arg in sys.argv:
         swig_bin = arg.split('=', 1)[1]
     elif arg.startswith('--make-clib'):
         make_clib = True
+    elif arg.startswith('--with-profile'):
+        make_profile = True
+    elif arg.startswith('--make-driver'):
+        # the headless driver links against the static library
+        make_clib = True
+        make_driver = True
     else:
         argv_replace.append(arg)
 
@@ -236,6 +244,37 @@ class qm_install_lib(install_lib.install_lib):
                 if sys.platform[:6] == "darwin":
                     spawn(['ranlib'] + [dest_file])
 
+            if make_driver:
+                build_driver(build_clib,self.get_finalized_command('install').install_scripts)
+
+# build the headless synthlisa-run driver and the synthlisa-bench
+# microbenchmarks (see lisasim/driver) against the static library, and
+# install them with the scripts
+
+driver_programs = ['synthlisa-run','synthlisa-bench']
+
+def build_driver(build_clib,install_dir):
+    from distutils.ccompiler import new_compiler
+    from distutils.sysconfig import customize_compiler
+
+    compiler = new_compiler()
+    customize_compiler(compiler)
+
+    mkpath(install_dir)
+
+    for program in driver_programs:
+        objects = compiler.compile(['lisasim/driver/' + program + '.cpp'],
+                                   output_dir = build_clib.build_temp,
+                                   include_dirs = ['lisasim'],
+                                   macros = lisasim_macros)
+
+        compiler.link_executable(objects,program,
+                                 output_dir = build_clib.build_clib,
+                                 libraries = ['synthlisa','stdc++','pthread','m'],
+                                 library_dirs = [build_clib.build_clib])
+
+        copy_file(os.path.join(build_clib.build_clib,program),install_dir)
+
 for entry in glob.glob('contrib/*'):
     if os.path.isdir(entry):
         contrib_packagename = os.path.basename(entry)
@@ -312,13 +351,26 @@ for entry in glob.glob('contrib/*'):
             synthlisapackages.append(contrib_packagename)
             synthlisapackage_dir[contrib_packagename] = entry
 
+# the per-stage profiler (see lisasim-profile.h) is compiled in only on request
+
+if make_profile == True:
+    lisasim_macros = [('SYNTHLISA_PROFILE',None)]
+else:
+    lisasim_macros = []
+
 # if we're asked to make a static .a library, set that up, and remove the old already-built library
 # which causes trouble to OS X's Universal Python...
 
+# the library holds the pure C++ core: the Python layer (lisasim-python.cpp,
+# with PyLISA, AllPyLISA, PyWave, and the Ctrl-C check) goes only into the
+# extension module, so the library can be linked without Python
+
+python_files = ['lisasim/lisasim-swig_wrap.cpp','lisasim/lisasim-python.cpp']
+
 if make_clib == True:
-    clibrary = [('synthlisa',{'sources': filter(lambda s: '_wrap.cpp' not in s,source_files),
+    clibrary = [('synthlisa',{'sources': filter(lambda s: s not in python_files,source_files),
                               'depends': header_files,
-                              'include_dirs': [numpy_hfiles, get_python_inc()]} )]
+                              'macros': lisasim_macros} )]
 
     # this hack needed on OS X for universal binaries since ar fails if the .a is already present...
 
@@ -364,6 +416,7 @@ setup(name = 'synthLISA',
       ext_modules = [Extension('synthlisa/_lisaswig',
                                source_files,
                                include_dirs = [numpy_hfiles],
+                               define_macros = lisasim_macros,
                                depends = header_files
                                )] + contribs
       )